@@ -0,0 +1,81 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "CMakeFiles/epoll_coroutine.dir/DependInfo.cmake"
+  "CMakeFiles/bench_epoll_rearm.dir/DependInfo.cmake"
+  "CMakeFiles/bench_work_stealing.dir/DependInfo.cmake"
+  "CMakeFiles/bench_timer_precision.dir/DependInfo.cmake"
+  "CMakeFiles/bench_busy_poll.dir/DependInfo.cmake"
+  "CMakeFiles/bench_timer_engines.dir/DependInfo.cmake"
+  "CMakeFiles/bench_timer_slack.dir/DependInfo.cmake"
+  "CMakeFiles/bench_heaps.dir/DependInfo.cmake"
+  "CMakeFiles/bench_frame_pool.dir/DependInfo.cmake"
+  "CMakeFiles/bench_frame_pool_malloc.dir/DependInfo.cmake"
+  "CMakeFiles/bench.dir/DependInfo.cmake"
+  "CMakeFiles/test_rbtree.dir/DependInfo.cmake"
+  "CMakeFiles/test_uring_cancel.dir/DependInfo.cmake"
+  "CMakeFiles/test_uring_destroy.dir/DependInfo.cmake"
+  "CMakeFiles/test_virtual_clock.dir/DependInfo.cmake"
+  "CMakeFiles/test_frame_arena.dir/DependInfo.cmake"
+  "CMakeFiles/test_frame_arena_malloc.dir/DependInfo.cmake"
+  "CMakeFiles/test_task_group.dir/DependInfo.cmake"
+  "CMakeFiles/test_runtime_steal.dir/DependInfo.cmake"
+  "CMakeFiles/test_post.dir/DependInfo.cmake"
+  "CMakeFiles/test_budget.dir/DependInfo.cmake"
+  "CMakeFiles/test_uring_nonblock.dir/DependInfo.cmake"
+  "CMakeFiles/test_coarse_timer.dir/DependInfo.cmake"
+  "CMakeFiles/test_cancel.dir/DependInfo.cmake"
+  "CMakeFiles/test_with_timeout.dir/DependInfo.cmake"
+  "CMakeFiles/test_interval.dir/DependInfo.cmake"
+  "CMakeFiles/test_timer_queue.dir/DependInfo.cmake"
+  "CMakeFiles/test_expected.dir/DependInfo.cmake"
+  )
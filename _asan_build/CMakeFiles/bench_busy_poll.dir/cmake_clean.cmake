@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_busy_poll.dir/bench/bench_busy_poll.cpp.o"
+  "CMakeFiles/bench_busy_poll.dir/bench/bench_busy_poll.cpp.o.d"
+  "bench_busy_poll"
+  "bench_busy_poll.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_busy_poll.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_epoll_rearm.dir/bench/bench_epoll_rearm.cpp.o"
+  "CMakeFiles/bench_epoll_rearm.dir/bench/bench_epoll_rearm.cpp.o.d"
+  "bench_epoll_rearm"
+  "bench_epoll_rearm.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_epoll_rearm.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_frame_pool_malloc.dir/bench/bench_frame_pool.cpp.o"
+  "CMakeFiles/bench_frame_pool_malloc.dir/bench/bench_frame_pool.cpp.o.d"
+  "bench_frame_pool_malloc"
+  "bench_frame_pool_malloc.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_frame_pool_malloc.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_heaps.dir/bench/bench_heaps.cpp.o"
+  "CMakeFiles/bench_heaps.dir/bench/bench_heaps.cpp.o.d"
+  "bench_heaps"
+  "bench_heaps.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_heaps.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_timer_engines.dir/bench/bench_timer_engines.cpp.o"
+  "CMakeFiles/bench_timer_engines.dir/bench/bench_timer_engines.cpp.o.d"
+  "bench_timer_engines"
+  "bench_timer_engines.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_timer_engines.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_timer_precision.dir/bench/bench_timer_precision.cpp.o"
+  "CMakeFiles/bench_timer_precision.dir/bench/bench_timer_precision.cpp.o.d"
+  "bench_timer_precision"
+  "bench_timer_precision.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_timer_precision.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
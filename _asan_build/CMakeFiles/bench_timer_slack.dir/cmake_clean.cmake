@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_timer_slack.dir/bench/bench_timer_slack.cpp.o"
+  "CMakeFiles/bench_timer_slack.dir/bench/bench_timer_slack.cpp.o.d"
+  "bench_timer_slack"
+  "bench_timer_slack.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_timer_slack.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
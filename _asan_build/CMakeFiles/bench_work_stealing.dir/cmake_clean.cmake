@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_work_stealing.dir/bench/bench_work_stealing.cpp.o"
+  "CMakeFiles/bench_work_stealing.dir/bench/bench_work_stealing.cpp.o.d"
+  "bench_work_stealing"
+  "bench_work_stealing.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_work_stealing.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/epoll_coroutine.dir/main.cpp.o"
+  "CMakeFiles/epoll_coroutine.dir/main.cpp.o.d"
+  "epoll_coroutine"
+  "epoll_coroutine.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/epoll_coroutine.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
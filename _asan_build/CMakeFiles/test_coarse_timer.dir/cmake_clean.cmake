@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_coarse_timer.dir/tests/test_coarse_timer.cpp.o"
+  "CMakeFiles/test_coarse_timer.dir/tests/test_coarse_timer.cpp.o.d"
+  "test_coarse_timer"
+  "test_coarse_timer.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_coarse_timer.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
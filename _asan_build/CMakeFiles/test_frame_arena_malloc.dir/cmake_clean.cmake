@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_frame_arena_malloc.dir/tests/test_frame_arena.cpp.o"
+  "CMakeFiles/test_frame_arena_malloc.dir/tests/test_frame_arena.cpp.o.d"
+  "test_frame_arena_malloc"
+  "test_frame_arena_malloc.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_frame_arena_malloc.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
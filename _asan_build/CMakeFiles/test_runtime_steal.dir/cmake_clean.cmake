@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_runtime_steal.dir/tests/test_runtime_steal.cpp.o"
+  "CMakeFiles/test_runtime_steal.dir/tests/test_runtime_steal.cpp.o.d"
+  "test_runtime_steal"
+  "test_runtime_steal.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_runtime_steal.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
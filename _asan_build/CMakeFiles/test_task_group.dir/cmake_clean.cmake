@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_task_group.dir/tests/test_task_group.cpp.o"
+  "CMakeFiles/test_task_group.dir/tests/test_task_group.cpp.o.d"
+  "test_task_group"
+  "test_task_group.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_task_group.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_timer_queue.dir/tests/test_timer_queue.cpp.o"
+  "CMakeFiles/test_timer_queue.dir/tests/test_timer_queue.cpp.o.d"
+  "test_timer_queue"
+  "test_timer_queue.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_timer_queue.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_uring_cancel.dir/tests/test_uring_cancel.cpp.o"
+  "CMakeFiles/test_uring_cancel.dir/tests/test_uring_cancel.cpp.o.d"
+  "test_uring_cancel"
+  "test_uring_cancel.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_uring_cancel.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
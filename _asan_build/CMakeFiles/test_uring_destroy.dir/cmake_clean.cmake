@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_uring_destroy.dir/tests/test_uring_destroy.cpp.o"
+  "CMakeFiles/test_uring_destroy.dir/tests/test_uring_destroy.cpp.o.d"
+  "test_uring_destroy"
+  "test_uring_destroy.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_uring_destroy.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
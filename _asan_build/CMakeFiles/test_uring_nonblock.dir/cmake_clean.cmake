@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_uring_nonblock.dir/tests/test_uring_nonblock.cpp.o"
+  "CMakeFiles/test_uring_nonblock.dir/tests/test_uring_nonblock.cpp.o.d"
+  "test_uring_nonblock"
+  "test_uring_nonblock.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_uring_nonblock.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_with_timeout.dir/tests/test_with_timeout.cpp.o"
+  "CMakeFiles/test_with_timeout.dir/tests/test_with_timeout.cpp.o.d"
+  "test_with_timeout"
+  "test_with_timeout.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_with_timeout.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,40 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo
+# Build directory: /root/repo/_asan_build
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test([=[test_rbtree]=] "/root/repo/_asan_build/test_rbtree")
+set_tests_properties([=[test_rbtree]=] PROPERTIES  SKIP_RETURN_CODE "77" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;59;add_test;/root/repo/CMakeLists.txt;64;add_co_async_test;/root/repo/CMakeLists.txt;0;")
+add_test([=[test_uring_cancel]=] "/root/repo/_asan_build/test_uring_cancel")
+set_tests_properties([=[test_uring_cancel]=] PROPERTIES  SKIP_RETURN_CODE "77" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;59;add_test;/root/repo/CMakeLists.txt;65;add_co_async_test;/root/repo/CMakeLists.txt;0;")
+add_test([=[test_uring_destroy]=] "/root/repo/_asan_build/test_uring_destroy")
+set_tests_properties([=[test_uring_destroy]=] PROPERTIES  SKIP_RETURN_CODE "77" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;59;add_test;/root/repo/CMakeLists.txt;66;add_co_async_test;/root/repo/CMakeLists.txt;0;")
+add_test([=[test_virtual_clock]=] "/root/repo/_asan_build/test_virtual_clock")
+set_tests_properties([=[test_virtual_clock]=] PROPERTIES  SKIP_RETURN_CODE "77" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;59;add_test;/root/repo/CMakeLists.txt;67;add_co_async_test;/root/repo/CMakeLists.txt;0;")
+add_test([=[test_frame_arena]=] "/root/repo/_asan_build/test_frame_arena")
+set_tests_properties([=[test_frame_arena]=] PROPERTIES  SKIP_RETURN_CODE "77" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;59;add_test;/root/repo/CMakeLists.txt;68;add_co_async_test;/root/repo/CMakeLists.txt;0;")
+add_test([=[test_frame_arena_malloc]=] "/root/repo/_asan_build/test_frame_arena_malloc")
+set_tests_properties([=[test_frame_arena_malloc]=] PROPERTIES  SKIP_RETURN_CODE "77" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;59;add_test;/root/repo/CMakeLists.txt;70;add_co_async_test;/root/repo/CMakeLists.txt;0;")
+add_test([=[test_task_group]=] "/root/repo/_asan_build/test_task_group")
+set_tests_properties([=[test_task_group]=] PROPERTIES  SKIP_RETURN_CODE "77" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;59;add_test;/root/repo/CMakeLists.txt;72;add_co_async_test;/root/repo/CMakeLists.txt;0;")
+add_test([=[test_runtime_steal]=] "/root/repo/_asan_build/test_runtime_steal")
+set_tests_properties([=[test_runtime_steal]=] PROPERTIES  SKIP_RETURN_CODE "77" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;59;add_test;/root/repo/CMakeLists.txt;73;add_co_async_test;/root/repo/CMakeLists.txt;0;")
+add_test([=[test_post]=] "/root/repo/_asan_build/test_post")
+set_tests_properties([=[test_post]=] PROPERTIES  SKIP_RETURN_CODE "77" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;59;add_test;/root/repo/CMakeLists.txt;74;add_co_async_test;/root/repo/CMakeLists.txt;0;")
+add_test([=[test_budget]=] "/root/repo/_asan_build/test_budget")
+set_tests_properties([=[test_budget]=] PROPERTIES  SKIP_RETURN_CODE "77" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;59;add_test;/root/repo/CMakeLists.txt;75;add_co_async_test;/root/repo/CMakeLists.txt;0;")
+add_test([=[test_uring_nonblock]=] "/root/repo/_asan_build/test_uring_nonblock")
+set_tests_properties([=[test_uring_nonblock]=] PROPERTIES  SKIP_RETURN_CODE "77" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;59;add_test;/root/repo/CMakeLists.txt;76;add_co_async_test;/root/repo/CMakeLists.txt;0;")
+add_test([=[test_coarse_timer]=] "/root/repo/_asan_build/test_coarse_timer")
+set_tests_properties([=[test_coarse_timer]=] PROPERTIES  SKIP_RETURN_CODE "77" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;59;add_test;/root/repo/CMakeLists.txt;77;add_co_async_test;/root/repo/CMakeLists.txt;0;")
+add_test([=[test_cancel]=] "/root/repo/_asan_build/test_cancel")
+set_tests_properties([=[test_cancel]=] PROPERTIES  SKIP_RETURN_CODE "77" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;59;add_test;/root/repo/CMakeLists.txt;78;add_co_async_test;/root/repo/CMakeLists.txt;0;")
+add_test([=[test_with_timeout]=] "/root/repo/_asan_build/test_with_timeout")
+set_tests_properties([=[test_with_timeout]=] PROPERTIES  SKIP_RETURN_CODE "77" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;59;add_test;/root/repo/CMakeLists.txt;79;add_co_async_test;/root/repo/CMakeLists.txt;0;")
+add_test([=[test_interval]=] "/root/repo/_asan_build/test_interval")
+set_tests_properties([=[test_interval]=] PROPERTIES  SKIP_RETURN_CODE "77" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;59;add_test;/root/repo/CMakeLists.txt;80;add_co_async_test;/root/repo/CMakeLists.txt;0;")
+add_test([=[test_timer_queue]=] "/root/repo/_asan_build/test_timer_queue")
+set_tests_properties([=[test_timer_queue]=] PROPERTIES  SKIP_RETURN_CODE "77" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;59;add_test;/root/repo/CMakeLists.txt;81;add_co_async_test;/root/repo/CMakeLists.txt;0;")
+add_test([=[test_expected]=] "/root/repo/_asan_build/test_expected")
+set_tests_properties([=[test_expected]=] PROPERTIES  SKIP_RETURN_CODE "77" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;59;add_test;/root/repo/CMakeLists.txt;82;add_co_async_test;/root/repo/CMakeLists.txt;0;")
@@ -0,0 +1,82 @@
+#include "co_async/debug.hpp"
+#include "co_async/async_loop.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * 另一个线程每隔 100us 向管道写入一个字节, 循环中的协程等待可读
+ * 记录从写入到协程恢复的时间, 对比阻塞等待和忙轮询两种模式的延迟直方图
+ */
+
+using namespace co_async;
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+static constexpr int kMessages = 2000;
+static constexpr std::array<double, 7> kBuckets{2, 5, 10, 20, 50, 100, 200};
+
+static Task<> reader(AsyncLoop &loop, AsyncFile &file, std::atomic<Clock::rep> &sent,
+                     std::vector<double> &latencies) {
+    char byte;
+    for (int i = 0; i < kMessages; ++i) {
+        co_await wait_file_event(loop, file, EPOLLIN);
+        auto now = Clock::now().time_since_epoch().count();
+        latencies.push_back(std::chrono::duration<double, std::micro>(
+                Clock::duration(now - sent.load(std::memory_order_acquire))).count());
+        readFileSync(file, {&byte, 1});
+    }
+}
+
+static void bench(std::chrono::nanoseconds spin) {
+    int fds[2];
+    checkError(pipe2(fds, O_NONBLOCK));
+    AsyncLoop loop;
+    loop.setBusyPoll(spin);
+    AsyncFile file(fds[0]);
+    std::atomic<Clock::rep> sent{0};
+    std::vector<double> latencies;
+    latencies.reserve(kMessages);
+    auto task = reader(loop, file, sent, latencies);
+    std::thread writer([&] {
+        for (int i = 0; i < kMessages; ++i) {
+            std::this_thread::sleep_for(100us);
+            sent.store(Clock::now().time_since_epoch().count(), std::memory_order_release);
+            [[maybe_unused]] auto res = write(fds[1], "x", 1);
+        }
+    });
+    run_task(loop, task);
+    writer.join();
+    close(fds[1]);
+
+    std::sort(latencies.begin(), latencies.end());
+    std::printf("%s spin %luus: p50 %.1fus p99 %.1fus, spin hits %zu/%zu\n",
+                spin.count() ? "busy-poll" : "blocking ", (unsigned long) (spin.count() / 1000),
+                latencies[kMessages / 2], latencies[kMessages * 99 / 100],
+                loop.stats().spinHits, loop.stats().spinPolls);
+    std::size_t begin = 0;
+    for (std::size_t i = 0; i <= kBuckets.size(); ++i) {
+        std::size_t end = i < kBuckets.size()
+                          ? std::lower_bound(latencies.begin(), latencies.end(), kBuckets[i]) - latencies.begin()
+                          : latencies.size();
+        if (i < kBuckets.size()) {
+            std::printf("  < %5.0fus %6zu\n", kBuckets[i], end - begin);
+        } else {
+            std::printf("  >=%5.0fus %6zu\n", kBuckets.back(), end - begin);
+        }
+        begin = end;
+    }
+}
+
+int main() {
+    bench(0ns);
+    bench(200us);
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "co_async/debug.hpp"
+#include "co_async/async_loop.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * 两个协程通过一对管道来回传递一个字节, 每次读取前都要在 epoll 中等待一次, 写入直接同步完成
+ * 统计每次读取的 epoll_ctl 调用数和耗时:
+ * 基线在每次读取之后 removeFile, 重现每次等待都 ADD + DEL 的旧路径, 每次读取 2 次 epoll_ctl;
+ * 常驻注册只有 MOD, 接近 1 次
+ */
+
+using namespace co_async;
+
+static constexpr int kRounds = 200000;
+
+static Task<> pingPong(EpollLoop &loop, AsyncFile &in, AsyncFile &out, bool first, bool addDel) {
+    char byte = 'x';
+    std::span<char> buffer(&byte, 1);
+    if (first) {
+        writeFileSync(out, buffer);
+    }
+    for (int i = 0; i < kRounds; ++i) {
+        co_await read_file(loop, in, buffer);
+        if (addDel) {
+            loop.removeFile(in.fileNo());
+        }
+        if (!first || i + 1 < kRounds) {
+            writeFileSync(out, buffer);
+        }
+    }
+}
+
+struct Result {
+    double ctlPerRead;
+    double nsPerRead;
+};
+
+static Result bench(bool addDel) {
+    int ab[2], ba[2];
+    checkError(pipe2(ab, O_NONBLOCK));
+    checkError(pipe2(ba, O_NONBLOCK));
+    AsyncLoop loop;
+    auto &epoll = static_cast<EpollLoop &>(loop);
+    AsyncFile aIn(ba[0]), aOut(ab[1]), bIn(ab[0]), bOut(ba[1]);
+    auto a = pingPong(epoll, aIn, aOut, true, addDel);
+    auto b = pingPong(epoll, bIn, bOut, false, addDel);
+    std::size_t ctlCalls = epoll.stats().ctlCalls;
+    std::size_t waitCalls = epoll.stats().waitCalls;
+    auto start = std::chrono::steady_clock::now();
+    spawn_task(b);
+    run_task(loop, a);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double reads = 2.0 * kRounds;
+    Result result{(double) (epoll.stats().ctlCalls - ctlCalls) / reads,
+                  std::chrono::duration<double, std::nano>(elapsed).count() / reads};
+    std::printf("%-10s epoll_ctl/read %.3f  epoll_wait/read %.3f  ns/read %.1f\n",
+                addDel ? "add/del" : "resident", result.ctlPerRead,
+                (double) (epoll.stats().waitCalls - waitCalls) / reads, result.nsPerRead);
+    return result;
+}
+
+int main() {
+    std::printf("reads      %d\n", 2 * kRounds);
+    Result before = bench(true);
+    Result after = bench(false);
+    std::printf("speedup    %.2fx, epoll_ctl %.3f -> %.3f per read\n",
+                before.nsPerRead / after.nsPerRead, before.ctlPerRead, after.ctlPerRead);
+    return 0;
+}
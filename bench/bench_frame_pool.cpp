@@ -0,0 +1,52 @@
+#include "co_async/debug.hpp"
+#include "co_async/async_loop.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+/**
+ * 协程帧创建与销毁的吞吐量: 每次迭代 co_await 两层嵌套的 Task, 共创建并销毁两个帧
+ * bench_frame_pool_malloc 是关闭 CO_ASYNC_FRAME_POOL 编译的同一个程序, 帧直接来自全局 operator new
+ */
+
+using namespace co_async;
+using Clock = std::chrono::steady_clock;
+
+static constexpr int kIterations = 2000000;
+
+static Task<int> leaf(int x) {
+    co_return x + 1;
+}
+
+static Task<int> middle(int x) {
+    co_return co_await leaf(x) * 2;
+}
+
+static Task<long> top(int count) {
+    long sum = 0;
+    for (int i = 0; i < count; ++i) {
+        sum += co_await middle(i);
+    }
+    co_return sum;
+}
+
+int main() {
+    AsyncLoop loop;
+    /* 预热, 让空闲链表中先有可用的块 */
+    run_task(loop, top(1000));
+    auto before = FramePool::stats();
+    auto start = Clock::now();
+    long sum = run_task(loop, top(kIterations));
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    auto const &after = FramePool::stats();
+    double frames = 2.0 * kIterations;
+    std::printf("frame pool %s: %.1f M frames/s, %.1f ns/frame (sum %ld)\n",
+                CO_ASYNC_FRAME_POOL ? "on " : "off", frames / seconds / 1e6, seconds * 1e9 / frames, sum);
+    if (CO_ASYNC_FRAME_POOL) {
+        std::size_t allocations = after.allocations - before.allocations;
+        std::size_t reused = after.reused - before.reused;
+        std::printf("  allocations %zu, reused %.4f, large %zu\n", allocations,
+                    allocations ? (double) reused / (double) allocations : 0.0, after.large - before.large);
+    }
+    return 0;
+}
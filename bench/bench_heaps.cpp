@@ -0,0 +1,90 @@
+#include "co_async/dary_heap.hpp"
+#include "co_async/pairing_heap.hpp"
+#include "co_async/rbtree.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+/**
+ * 三种侵入式容器在定时器队列典型操作上的开销:
+ * 插入 n 个随机键, 随机删除一半(被取消的超时), 再依次弹出最小值直到为空(到期)
+ */
+
+using namespace co_async;
+using Clock = std::chrono::steady_clock;
+
+template <class Node>
+struct Item : Node {
+    std::uint64_t m_key = 0;
+
+    friend bool operator<(Item const &lhs, Item const &rhs) noexcept {
+        return lhs.m_key < rhs.m_key;
+    }
+};
+
+struct RbItem : Item<RbTree<RbItem>::RbNode> {};
+struct DaryItem : Item<DaryHeap<DaryItem>::Node> {};
+struct PairingItem : Item<PairingHeap<PairingItem>::Node> {};
+
+static double nanosecondsPer(Clock::time_point start, std::size_t count) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (double) count;
+}
+
+template <class Queue, class Value>
+static void bench(char const *name, std::size_t count) {
+    std::mt19937_64 rng(7);
+    std::vector<Value> values(count);
+    for (auto &value : values) {
+        value.m_key = rng();
+    }
+    std::vector<std::size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rng);
+
+    Queue queue;
+    auto start = Clock::now();
+    for (auto &value : values) {
+        queue.insert(value);
+    }
+    double insert = nanosecondsPer(start, count);
+
+    std::size_t erased = count / 2;
+    start = Clock::now();
+    for (std::size_t i = 0; i < erased; ++i) {
+        queue.erase(values[order[i]]);
+    }
+    double erase = nanosecondsPer(start, erased);
+
+    start = Clock::now();
+    std::uint64_t last = 0;
+    while (!queue.empty()) {
+        auto &front = queue.front();
+        if (front.m_key < last) [[unlikely]] {
+            std::printf("%s: out of order\n", name);
+        }
+        last = front.m_key;
+        if constexpr (requires { queue.popFront(); }) {
+            queue.popFront();
+        } else {
+            queue.erase(front);
+        }
+    }
+    double pop = nanosecondsPer(start, count - erased);
+
+    std::printf("%-8s n=%-8zu insert %6.1fns  erase %6.1fns  pop-min %6.1fns\n",
+                name, count, insert, erase, pop);
+}
+
+int main() {
+    for (std::size_t count : {1000, 100000, 1000000}) {
+        bench<RbTree<RbItem>, RbItem>("rbtree", count);
+        bench<DaryHeap<DaryItem>, DaryItem>("4-heap", count);
+        bench<PairingHeap<PairingItem>, PairingItem>("pairing", count);
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "co_async/debug.hpp"
+#include "co_async/timer_loop.hpp"
+
+#include <chrono>
+#include <coroutine>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+/**
+ * 100 万个同时存在的定时器在各个定时器引擎上的开销:
+ * 先全部插入(到期时间在 1s~60s 之间随机), 再随机挑选定时器推迟 400 万次(请求超时被刷新),
+ * 最后让它们全部到期. 使用 VirtualClock, 到期阶段不需要真的等待, 只测数据结构本身
+ */
+
+using namespace co_async;
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::size_t kTimers = 1000000;
+static constexpr std::size_t kChurn = 4000000;
+
+static double nanosecondsPer(Clock::time_point start, std::size_t count) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (double) count;
+}
+
+template <template <class> class Queue>
+static void bench(char const *name) {
+    using Loop = BasicTimerLoop<Queue, VirtualClock>;
+    VirtualClock::reset();
+    Loop loop;
+    std::vector<typename Loop::TimerNode> nodes(kTimers);
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<std::int64_t> deadline(1000, 60000);
+
+    auto start = Clock::now();
+    for (auto &node : nodes) {
+        node.m_expireTime = VirtualClock::now() + std::chrono::milliseconds(deadline(rng));
+        node.m_coroutine = std::noop_coroutine();
+        loop.addTimer(node);
+    }
+    double insert = nanosecondsPer(start, kTimers);
+
+    start = Clock::now();
+    for (std::size_t i = 0; i < kChurn; ++i) {
+        auto &node = nodes[rng() % kTimers];
+        loop.cancelTimer(node);
+        node.m_expireTime = VirtualClock::now() + std::chrono::milliseconds(deadline(rng));
+        loop.addTimer(node);
+    }
+    double churn = nanosecondsPer(start, kChurn);
+
+    start = Clock::now();
+    while (loop.run()) {
+    }
+    double expire = nanosecondsPer(start, kTimers);
+
+    std::printf("%-8s insert %6.1fns  re-arm %6.1fns  expire %6.1fns  wakeups %zu\n",
+                name, insert, churn, expire, loop.stats().wakeups);
+}
+
+int main() {
+    bench<OrderedTimerQueue>("rbtree");
+    bench<TimingWheel>("wheel");
+    bench<HeapTimerQueue>("4-heap");
+    bench<PairingTimerQueue>("pairing");
+    return 0;
+}
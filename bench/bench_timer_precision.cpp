@@ -0,0 +1,59 @@
+#include "co_async/debug.hpp"
+#include "co_async/async_loop.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <sys/resource.h>
+
+/**
+ * 不足 1ms 和非整数毫秒的 sleep_for 的唤醒误差与 CPU 占用
+ * 毫秒截断的实现里 300us 的等待变成 0 超时的空转, 1.9ms 的等待会提前醒来;
+ * 使用 epoll_pwait2 之后每次睡眠只需要一两次 epoll 等待, CPU 时间远小于墙上时间
+ */
+
+using namespace co_async;
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+static constexpr int kSleeps = 500;
+
+static double cpuMilliseconds() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e3
+           + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e3;
+}
+
+static Task<> sleeper(AsyncLoop &loop, Clock::duration duration, double &average, double &worst) {
+    for (int i = 0; i < kSleeps; ++i) {
+        auto start = Clock::now();
+        co_await sleep_for(loop, duration);
+        double error = std::chrono::duration<double, std::micro>(Clock::now() - start - duration).count();
+        average += error / kSleeps;
+        worst = std::max(worst, error);
+    }
+}
+
+static void bench(Clock::duration duration) {
+    AsyncLoop loop;
+    double average = 0, worst = 0;
+    auto waits = static_cast<EpollLoop &>(loop).stats().waitCalls;
+    double cpu = cpuMilliseconds();
+    auto start = Clock::now();
+    run_task(loop, sleeper(loop, duration, average, worst));
+    double wall = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    cpu = cpuMilliseconds() - cpu;
+    waits = static_cast<EpollLoop &>(loop).stats().waitCalls - waits;
+    std::printf("sleep %6.0fus  error avg %6.1fus max %7.1fus  waits/sleep %5.2f  cpu %5.1f%%\n",
+                std::chrono::duration<double, std::micro>(duration).count(), average, worst,
+                (double) waits / kSleeps, 100.0 * cpu / wall);
+}
+
+int main() {
+    bench(100us);
+    bench(300us);
+    bench(900us);
+    bench(1900us);
+    return 0;
+}
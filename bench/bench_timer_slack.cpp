@@ -0,0 +1,67 @@
+#include "co_async/debug.hpp"
+#include "co_async/async_loop.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <sys/resource.h>
+#include <vector>
+
+/**
+ * 两万个连接各自的超时均匀分布在 1 秒之内, 比较不同的合并窗口(slack)下
+ * 每秒的唤醒次数、每次唤醒处理的定时器数、CPU 时间以及最大的推迟
+ */
+
+using namespace co_async;
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+static constexpr int kTimers = 20000;
+
+static double cpuSeconds() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (double) (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+           + (double) (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+static Task<> timeout(AsyncLoop &loop, Clock::time_point deadline, Clock::duration &latest) {
+    co_await sleep_until(loop, deadline);
+    auto late = Clock::now() - deadline;
+    if (late > latest) {
+        latest = late;
+    }
+}
+
+static void bench(std::chrono::milliseconds slack) {
+    AsyncLoop loop;
+    loop.setTimerSlack(slack);
+    std::mt19937 rng(1);
+    Clock::duration latest{};
+    /* 留出创建任务的时间, 最大推迟只反映合并窗口 */
+    auto start = Clock::now() + 50ms;
+    std::vector<Task<>> tasks;
+    tasks.reserve(kTimers);
+    for (int i = 0; i < kTimers; ++i) {
+        tasks.push_back(timeout(loop, start + std::chrono::nanoseconds(rng() % 1000000000), latest));
+        spawn_task(tasks.back());
+    }
+    double cpu = cpuSeconds();
+    auto begin = Clock::now();
+    while (loop.run()) {
+    }
+    double wall = std::chrono::duration<double>(Clock::now() - begin).count();
+    cpu = cpuSeconds() - cpu;
+    auto const &stats = loop.timerStats();
+    std::printf("slack %2ldms  wakeups/s %6.0f  fired/wakeup %5.1f  cpu %.3fs  max late %.2fms\n",
+                (long) slack.count(), (double) stats.wakeups / wall, stats.firedPerWakeup(), cpu,
+                std::chrono::duration<double, std::milli>(latest).count());
+}
+
+int main() {
+    bench(0ms);
+    bench(1ms);
+    bench(5ms);
+    bench(20ms);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include "co_async/debug.hpp"
+#include "co_async/runtime.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+/**
+ * 偏斜负载: 所有任务都在第 0 个循环里创建, 每个任务先做一段计算再短暂睡眠
+ * 对比固定分配(全部留在第 0 个循环)和工作窃取(空闲线程从第 0 个循环的双端队列窃取)时
+ * 从开始到每个任务结束的延迟分布
+ * 两种模式交替运行多次, 最后给出各自 p99 的中位数和最小值
+ *
+ * 窃取只能把计算分摊到其他核心上: 至少需要与线程数相同的空闲核心才能看到 p99 的差别,
+ * 单核机器上两种模式都是串行执行, 结果应当相同
+ *
+ *     bench_work_stealing [线程数, 默认 4] [轮数, 默认 5]
+ */
+
+using namespace co_async;
+using Clock = std::chrono::steady_clock;
+
+static constexpr int kTasks = 4000;
+
+static std::atomic<long> sink{0};
+
+static Task<> work(AsyncLoop &loop, Clock::time_point start, double &latency, int i) {
+    long x = 0;
+    for (int k = 0; k < 20000; ++k) {
+        x += k * (long) i ^ (x >> 3);
+    }
+    sink.fetch_add(x, std::memory_order_relaxed);
+    co_await sleep_for(loop, std::chrono::microseconds(100));
+    latency = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+struct Result {
+    double p50;
+    double p99;
+};
+
+static Result bench(std::size_t threads, bool stealing) {
+    Runtime runtime(threads, false);
+    runtime.setStealing(stealing);
+    std::vector<double> latencies(kTasks);
+    auto start = Clock::now();
+    runtime.spawn(0, [&](AsyncLoop &) -> Task<> {
+        for (int i = 0; i < kTasks; ++i) {
+            auto factory = [&, i](AsyncLoop &loop) {
+                return work(loop, start, latencies[i], i);
+            };
+            if (stealing) {
+                runtime.spawn(factory);
+            } else {
+                runtime.spawn(0, factory);
+            }
+        }
+        co_return;
+    });
+    runtime.run();
+    std::sort(latencies.begin(), latencies.end());
+    Result result{latencies[kTasks / 2], latencies[kTasks * 99 / 100]};
+    std::printf("  %-8s p50 %8.0fus  p99 %8.0fus  stolen %zu\n", stealing ? "stealing" : "static",
+                result.p50, result.p99, runtime.stolen());
+    return result;
+}
+
+static double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+int main(int argc, char **argv) {
+    std::size_t threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4;
+    int runs = argc > 2 ? std::atoi(argv[2]) : 5;
+    threads = std::max<std::size_t>(threads, 1);
+    runs = std::max(runs, 1);
+    unsigned cores = std::thread::hardware_concurrency();
+    std::printf("%zu threads, %u cores, %d runs\n", threads, cores, runs);
+    if (cores < threads) {
+        std::printf("warning: fewer cores than threads, stealing cannot lower p99 here\n");
+    }
+    std::vector<double> staticP99, stealingP99;
+    for (int run = 0; run < runs; ++run) {
+        std::printf("run %d\n", run + 1);
+        staticP99.push_back(bench(threads, false).p99);
+        stealingP99.push_back(bench(threads, true).p99);
+    }
+    double staticMedian = median(staticP99), stealingMedian = median(stealingP99);
+    std::printf("p99 median: static %8.0fus  stealing %8.0fus  (%.2fx)\n",
+                staticMedian, stealingMedian, staticMedian / stealingMedian);
+    std::printf("p99 best:   static %8.0fus  stealing %8.0fus\n",
+                *std::min_element(staticP99.begin(), staticP99.end()),
+                *std::min_element(stealingP99.begin(), stealingP99.end()));
+    return 0;
+}
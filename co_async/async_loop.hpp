@@ -1,36 +1,251 @@
 #pragma once
 
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <chrono>
+#include <optional>
+#include <type_traits>
+#include "error_handling.hpp"
 #include "timer_loop.hpp"
 #include "epoll_loop.hpp"
-#include <thread>
+#include "uring_loop.hpp"
 
 namespace co_async {
 
-    struct AsyncLoop {
-        void run() {
-            while (true) {
-                auto timeout = mTimerLoop.run();
-                if (mEpollLoop.hasEvent()) {
-                    mEpollLoop.run(timeout);
-                } else if (timeout) {
-                    std::this_thread::sleep_for(*timeout);
-                } else {
-                    break;
-                }
+    /**
+     * 同时驱动定时器与 I/O 的事件循环
+     * IoLoop 可以是 EpollLoop 或者 UringLoop, 后者是 EpollLoop 的派生类,
+     * 所有接受 EpollLoop& 的等待函数对两者都适用
+     */
+    template <class TimerLoopT = TimerLoop, class IoLoopT = EpollLoop>
+    struct BasicAsyncLoop {
+        using TimerLoopType = TimerLoopT;
+        using IoLoopType = IoLoopT;
+
+        /**
+         * 运行一轮事件循环, 与 EpollLoop::run 一致, 返回 false 表示没有更多的任务
+         */
+        bool run() {
+            if constexpr (TimerLoopType::kVirtualClock) {
+                return runVirtual();
+            }
+            auto timeout = mTimerLoop.runExpired();
+            if (mTimerFd != -1) {
+                armTimerFd(timeout);
+                timeout = std::nullopt;
+            }
+            if (!timeout && !mEpollLoop.hasEvent()) {
+                return false;
+            }
+            /* 定时器、fd 事件和跨线程投递共用同一次 epoll 等待, 不单独睡眠 */
+            mEpollLoop.run(timeout);
+            return true;
+        }
+
+        /**
+         * 见 EpollLoop::schedule, 只能在本循环的线程调用
+         */
+        void schedule(std::coroutine_handle<> coroutine) {
+            mEpollLoop.schedule(coroutine);
+        }
+
+        /**
+         * 见 EpollLoop::post, 可以在任意线程调用
+         */
+        void post(std::coroutine_handle<> coroutine) {
+            mEpollLoop.post(coroutine);
+        }
+
+        void retain() noexcept {
+            mEpollLoop.retain();
+        }
+
+        void release() noexcept {
+            mEpollLoop.release();
+        }
+
+        /**
+         * epoll_wait 的批量大小, 见 EpollLoop::setBatchSize
+         */
+        void setBatchSize(std::size_t size) {
+            mEpollLoop.setBatchSize(size);
+        }
+
+        void setMaxBatchSize(std::size_t size) noexcept {
+            mEpollLoop.setMaxBatchSize(size);
+        }
+
+        void setDrain(bool drain) noexcept {
+            mEpollLoop.setDrain(drain);
+        }
+
+        void setBudget(std::size_t budget) noexcept {
+            mEpollLoop.setBudget(budget);
+        }
+
+        void setBusyPoll(std::chrono::nanoseconds spin, int socketBusyPoll = 0) noexcept {
+            mEpollLoop.setBusyPoll(spin, socketBusyPoll);
+        }
+
+        EpollLoopStats const &stats() const noexcept {
+            return mEpollLoop.stats();
+        }
+
+        /**
+         * 定时器合并的容许延迟, 见 BasicTimerLoop::setSlack
+         */
+        template <class Rep, class Period>
+        void setTimerSlack(std::chrono::duration<Rep, Period> slack) noexcept {
+            mTimerLoop.setSlack(std::chrono::duration_cast<typename TimerLoopType::ClockType::duration>(slack));
+        }
+
+        TimerLoopStats const &timerStats() const noexcept {
+            return mTimerLoop.stats();
+        }
+
+        /**
+         * 开启后把最早的到期时间以绝对时间写入一个注册在 epoll 中的 timerfd,
+         * 定时器和 fd 事件走同一条事件路径, epoll 总是无限期阻塞, 不再换算超时
+         * 到期时间不变时不会重复调用 timerfd_settime
+         * 只适用于以 CLOCK_MONOTONIC 为基准的时钟 (steady_clock 和 CoarseSteadyClock)
+         * 写入的到期时间是精确时钟的当前时间加上 runExpired 算出的超时, 对 CoarseSteadyClock 超时已经多出一个时钟节拍,
+         * timerfd 到期后读到的粗略时间不会还没到
+         */
+        void setTimerFd(bool enable) {
+            static_assert(std::is_same_v<typename TimerLoopType::ClockType::time_point::clock,
+                                         std::chrono::steady_clock>,
+                          "timerfd requires a CLOCK_MONOTONIC based clock");
+            if (enable == (mTimerFd != -1)) {
+                return;
+            }
+            if (enable) {
+                mTimerFd = checkError(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC));
+                mEpollLoop.addWatcher(mTimerFd, EPOLLIN, onTimerFd, this);
+            } else {
+                closeTimerFd();
+            }
+        }
+
+        ~BasicAsyncLoop() {
+            closeTimerFd();
+        }
+
+    private:
+        /**
+         * 虚拟时钟下的一轮: 先处理到期的定时器, 再不阻塞地运行就绪的协程和 fd 事件;
+         * 只有这一轮什么也没有发生(循环本来要阻塞)时, 才把时间直接推进到下一个定时器
+         */
+        bool runVirtual() {
+            auto timeout = mTimerLoop.runExpired();
+            auto events = mEpollLoop.stats().events;
+            bool ready = mEpollLoop.hasReady();
+            if (!timeout && !ready && !mEpollLoop.hasEvent()) {
+                return false;
+            }
+            if (!timeout && !ready) {
+                /* 只剩下 fd, 虚拟时间没有意义, 阻塞等待 */
+                mEpollLoop.run();
+                return true;
             }
+            mEpollLoop.run(std::chrono::nanoseconds::zero());
+            if (ready || mEpollLoop.hasReady() || mEpollLoop.stats().events != events) {
+                return true;
+            }
+            TimerLoopType::ClockType::advance(*timeout);
+            return true;
         }
 
-        operator TimerLoop &() {
+    public:
+
+        operator TimerLoopType &() {
             return mTimerLoop;
         }
 
-        operator EpollLoop &() {
+        operator IoLoopType &() {
             return mEpollLoop;
         }
 
     private:
-        TimerLoop mTimerLoop;
-        EpollLoop mEpollLoop;
+        using TimePoint = typename TimerLoopType::ClockType::time_point;
+
+        /**
+         * 还有定时器时持有 mEpollLoop, 让它在没有 fd 的情况下也阻塞等待 timerfd
+         */
+        void armTimerFd(std::optional<typename TimerLoopType::ClockType::duration> timeout) {
+            if (!timeout) {
+                if (mTimerFdHeld) {
+                    struct itimerspec spec{};
+                    checkError(timerfd_settime(mTimerFd, TFD_TIMER_ABSTIME, &spec, nullptr));
+                    mTimerFdDeadline = std::nullopt;
+                    mTimerFdHeld = false;
+                    mEpollLoop.release();
+                }
+                return;
+            }
+            if (!mTimerFdHeld) {
+                mTimerFdHeld = true;
+                mEpollLoop.retain();
+            }
+            TimePoint deadline = mTimerLoop.now() + *timeout;
+            if (mTimerFdDeadline == deadline) {
+                return;
+            }
+            /* 粗略时钟空闲后可能落后不止一个节拍, 从它算出的绝对时间已经过去, timerfd 会立即到期, 循环空转;
+             * 写入的时间以精确时钟为基准, 去重仍然用定时器循环自己的时间 */
+            auto expiry = std::chrono::steady_clock::now() + *timeout;
+            auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(expiry.time_since_epoch());
+            auto seconds = std::chrono::floor<std::chrono::seconds>(sinceEpoch);
+            struct itimerspec spec{};
+            spec.it_value.tv_sec = seconds.count();
+            spec.it_value.tv_nsec = (sinceEpoch - seconds).count();
+            /* it_value 全为 0 表示解除, 已经过去的时间点至少写 1ns, 立即到期 */
+            if (spec.it_value.tv_sec <= 0 && spec.it_value.tv_nsec == 0) {
+                spec.it_value.tv_sec = 0;
+                spec.it_value.tv_nsec = 1;
+            }
+            checkError(timerfd_settime(mTimerFd, TFD_TIMER_ABSTIME, &spec, nullptr));
+            mTimerFdDeadline = deadline;
+        }
+
+        /* 到期后 timerfd 已经解除, 下一轮无论时间是否相同都要重新写入 */
+        static void onTimerFd(void *context) {
+            auto &self = *static_cast<BasicAsyncLoop *>(context);
+            std::uint64_t count;
+            [[maybe_unused]] auto res = read(self.mTimerFd, &count, sizeof(count));
+            self.mTimerFdDeadline = std::nullopt;
+        }
+
+        void closeTimerFd() noexcept {
+            if (mTimerFd == -1) {
+                return;
+            }
+            if (mTimerFdHeld) {
+                mTimerFdHeld = false;
+                mEpollLoop.release();
+            }
+            mEpollLoop.removeWatcher(mTimerFd);
+            close(mTimerFd);
+            mTimerFd = -1;
+            mTimerFdDeadline = std::nullopt;
+        }
+
+        TimerLoopType mTimerLoop;
+        IoLoopType mEpollLoop;
+        int mTimerFd = -1;
+        /* 当前写入 timerfd 的到期时间, 空表示没有设定 */
+        std::optional<TimePoint> mTimerFdDeadline;
+        bool mTimerFdHeld = false;
     };
 
-} // namespace co_async
\ No newline at end of file
+    using AsyncLoop = BasicAsyncLoop<>;
+    /* 读写走 io_uring, 内核不支持时自动退化为 epoll */
+    using UringAsyncLoop = BasicAsyncLoop<TimerLoop, UringLoop>;
+    /* 定时器存放在时间轮中 */
+    using WheelAsyncLoop = BasicAsyncLoop<WheelTimerLoop>;
+    /* 定时器存放在 4 叉堆或配对堆中 */
+    using HeapAsyncLoop = BasicAsyncLoop<HeapTimerLoop>;
+    using PairingAsyncLoop = BasicAsyncLoop<PairingTimerLoop>;
+    /* 使用虚拟时钟的模拟循环, fd 事件照常处理, 但不会为定时器等待 */
+    using VirtualAsyncLoop = BasicAsyncLoop<VirtualTimerLoop>;
+
+} // namespace co_async
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <cassert>
+#include <coroutine>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+
+namespace co_async {
+
+    struct CancelState;
+    struct CancelNode;
+
+    /**
+     * CancelNode 组成的双向链表, 新节点登记在表头, 排队等待回调的节点追加在表尾
+     */
+    struct CancelList {
+        CancelNode *m_head = nullptr;
+        CancelNode *m_tail = nullptr;
+    };
+
+    /**
+     * 挂起中的等待者在取消源上登记的节点, 取消时调用 callback(context)
+     * 嵌入在等待者中, 恢复或析构时注销, 不需要分配内存
+     * 取消之后到回调之前, 节点挂在当前线程的待处理表中, 等待者在此期间被销毁同样会注销
+     */
+    struct CancelNode {
+        CancelNode() noexcept = default;
+
+        CancelNode(CancelNode &&) = delete;
+
+        ~CancelNode() {
+            unlink();
+        }
+
+        /* state 为空时什么也不做 */
+        inline void link(CancelState *state, void (*callback)(void *context), void *context) noexcept;
+
+        inline void unlink() noexcept;
+
+    private:
+        friend struct CancelState;
+
+        inline void pushFront(CancelList &list) noexcept;
+        inline void pushBack(CancelList &list) noexcept;
+
+        CancelList *m_list = nullptr;
+        CancelNode *m_prev = nullptr;
+        CancelNode *m_next = nullptr;
+        void (*m_callback)(void *context) = nullptr;
+        void *m_context = nullptr;
+    };
+
+    /**
+     * 取消源的状态: 是否已经取消, 以及当前挂起在它上面的等待者
+     * 没有任何同步, 只能在创建它的线程(即等待者所在的事件循环线程)中使用,
+     * 调试模式下在登记、取消和重置时断言这一点; 其他线程需要取消时先 post 到循环线程
+     */
+    struct CancelState {
+        CancelState() noexcept = default;
+
+        CancelState(CancelState &&) = delete;
+
+        ~CancelState() {
+            while (m_waiters.m_head) {
+                m_waiters.m_head->unlink();
+            }
+        }
+
+        bool cancelled() const noexcept {
+            return m_cancelled;
+        }
+
+        /**
+         * 标记为已取消, 把所有挂起的等待者移到当前线程的待处理表中
+         * 这里不恢复任何协程: 事件循环在下一轮开始时调用 runPending, 由回调撤销等待并恢复等待者,
+         * 它们在恢复后抛出 errc::operation_canceled (try_ 版本返回错误码)
+         * 调用者因此可以在 cancel 之后继续运行, 不会被等待者的恢复重入
+         */
+        void cancel() {
+            checkThread();
+            if (m_cancelled) {
+                return;
+            }
+            m_cancelled = true;
+            while (CancelNode *node = m_waiters.m_head) {
+                node->unlink();
+                node->pushBack(tPending);
+            }
+        }
+
+        /**
+         * 依次调用当前线程中待处理的取消回调, 期间新的取消追加在表尾, 一并处理
+         * 由事件循环在恢复就绪协程的同一位置调用
+         * @return 是否调用了回调
+         */
+        static bool runPending() {
+            if (tPending.m_head == nullptr) {
+                return false;
+            }
+            while (CancelNode *node = tPending.m_head) {
+                node->unlink();
+                node->m_callback(node->m_context);
+            }
+            return true;
+        }
+
+        /* 当前线程是否有等待调用的取消回调, 有的话循环不能阻塞 */
+        static bool hasPending() noexcept {
+            return tPending.m_head != nullptr;
+        }
+
+        void reset() noexcept {
+            checkThread();
+            m_cancelled = false;
+        }
+
+    private:
+        friend struct CancelNode;
+
+        void checkThread() const noexcept {
+#ifndef NDEBUG
+            assert(m_owner == std::this_thread::get_id() && "CancelState used outside its loop thread");
+#endif
+        }
+
+        CancelList m_waiters;
+        bool m_cancelled = false;
+#ifndef NDEBUG
+        std::thread::id m_owner = std::this_thread::get_id();
+#endif
+
+        static inline thread_local CancelList tPending;
+    };
+
+    void CancelNode::link(CancelState *state, void (*callback)(void *context), void *context) noexcept {
+        if (state == nullptr) {
+            return;
+        }
+        state->checkThread();
+        m_callback = callback;
+        m_context = context;
+        pushFront(state->m_waiters);
+    }
+
+    void CancelNode::pushFront(CancelList &list) noexcept {
+        m_list = &list;
+        m_prev = nullptr;
+        m_next = list.m_head;
+        if (m_next) {
+            m_next->m_prev = this;
+        } else {
+            list.m_tail = this;
+        }
+        list.m_head = this;
+    }
+
+    void CancelNode::pushBack(CancelList &list) noexcept {
+        m_list = &list;
+        m_next = nullptr;
+        m_prev = list.m_tail;
+        if (m_prev) {
+            m_prev->m_next = this;
+        } else {
+            list.m_head = this;
+        }
+        list.m_tail = this;
+    }
+
+    void CancelNode::unlink() noexcept {
+        if (m_list == nullptr) {
+            return;
+        }
+        if (m_prev) {
+            m_prev->m_next = m_next;
+        } else {
+            m_list->m_head = m_next;
+        }
+        if (m_next) {
+            m_next->m_prev = m_prev;
+        } else {
+            m_list->m_tail = m_prev;
+        }
+        m_list = nullptr;
+        m_prev = m_next = nullptr;
+    }
+
+    /**
+     * 取消源的只读视图, 可以随意复制, 空的 CancelToken 永远不会被取消
+     */
+    struct CancelToken {
+        CancelToken() noexcept = default;
+
+        explicit CancelToken(CancelState *state) noexcept : m_state(state) {}
+
+        bool cancelled() const noexcept {
+            return m_state && m_state->cancelled();
+        }
+
+        /* 是否关联了取消源 */
+        bool cancellable() const noexcept {
+            return m_state != nullptr;
+        }
+
+        CancelState *state() const noexcept {
+            return m_state;
+        }
+
+    private:
+        CancelState *m_state = nullptr;
+    };
+
+    /**
+     * 取消源, 一般每个请求或连接一个, 必须比关联的协程活得更久
+     * cancel 只能在事件循环线程中调用, 等待者在循环的下一轮中恢复, 见 CancelState
+     *
+     *     CancelSource source;
+     *     auto task = with_cancel(handleRequest(loop, file), source.token());
+     *     ...
+     *     source.cancel(); // 客户端断开, 整个请求子树中挂起的 epoll/定时器等待全部被唤醒
+     */
+    struct CancelSource {
+        CancelSource() noexcept = default;
+
+        CancelSource(CancelSource &&) = delete;
+
+        CancelToken token() noexcept {
+            return CancelToken(&m_state);
+        }
+
+        void cancel() {
+            m_state.cancel();
+        }
+
+        bool cancelled() const noexcept {
+            return m_state.cancelled();
+        }
+
+        /* 重新用于下一个请求, 此前已经取消的等待不受影响 */
+        void reset() noexcept {
+            m_state.reset();
+        }
+
+    private:
+        CancelState m_state;
+    };
+
+    /**
+     * promise_type 继承它之后, 协程可以关联一个 CancelToken
+     * co_await 一个 Task 时, 子协程没有自己的 CancelToken 就继承父协程的, 取消因此沿着调用链向下传递
+     */
+    struct CancellablePromise {
+        CancelToken mCancelToken;
+    };
+
+    /**
+     * 取出协程关联的 CancelToken, 不支持取消的协程返回空
+     */
+    template <class P>
+    CancelToken cancelTokenOf(std::coroutine_handle<P> coroutine) noexcept {
+        if constexpr (std::is_base_of_v<CancellablePromise, P>) {
+            return coroutine.promise().mCancelToken;
+        } else {
+            return CancelToken();
+        }
+    }
+
+    /* 被取消的等待者在恢复后抛出的异常, Task<Expected<T>> 中会转换为错误码 */
+    [[noreturn]] inline void throwCancelled() {
+        throw std::system_error(std::make_error_code(std::errc::operation_canceled));
+    }
+
+    /**
+     * co_await 它取得当前协程的 CancelToken, 不会挂起, 用于在计算密集的循环中主动检查
+     */
+    struct CurrentCancelTokenAwaiter {
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        template <class P>
+        bool await_suspend(std::coroutine_handle<P> coroutine) noexcept {
+            mToken = cancelTokenOf(coroutine);
+            return false;
+        }
+
+        CancelToken await_resume() const noexcept {
+            return mToken;
+        }
+
+        CancelToken mToken;
+    };
+
+    inline CurrentCancelTokenAwaiter current_cancel_token() noexcept {
+        return {};
+    }
+
+} // namespace co_async
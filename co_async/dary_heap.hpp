@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace co_async {
+
+    /**
+     * 侵入式 D 叉最小堆, 元素继承 DaryHeap::Node, 堆中只保存指向节点的指针
+     * 节点记录自己在数组中的下标, 所以可以 O(log n) 删除任意元素;
+     * 同一个节点的孩子指针在数组中相邻, 4 叉时层数只有二叉堆的一半, 也没有红黑树那样的指针追逐
+     * 和 RbNode 一样, 节点析构时自动从堆中摘除
+     */
+    template <class Value, class Compare = std::less<Value>, std::size_t D = 4>
+    struct DaryHeap {
+        static_assert(D >= 2);
+
+        struct Node {
+            Node() noexcept = default;
+
+            Node(Node &&) = delete;
+
+            ~Node() noexcept {
+                if (m_heap) {
+                    m_heap->erase(static_cast<Value &>(*this));
+                }
+            }
+
+            friend struct DaryHeap;
+
+        private:
+            DaryHeap *m_heap = nullptr;
+            std::size_t m_index = 0;
+        };
+
+        DaryHeap() = default;
+
+        explicit DaryHeap(Compare comp) noexcept(noexcept(Compare(comp))) : m_comp(comp) {}
+
+        DaryHeap(DaryHeap &&) = delete;
+
+        void insert(Value &value) {
+            Node &node = value;
+            m_nodes.push_back(&node);
+            node.m_heap = this;
+            siftUp(m_nodes.size() - 1);
+        }
+
+        void erase(Value &value) noexcept {
+            Node &node = value;
+            std::size_t index = node.m_index;
+            node.m_heap = nullptr;
+            Node *last = m_nodes.back();
+            m_nodes.pop_back();
+            if (last == &node) {
+                return;
+            }
+            place(index, last);
+            if (index != 0 && less(last, m_nodes[parentOf(index)])) {
+                siftUp(index);
+            } else {
+                siftDown(index);
+            }
+        }
+
+        bool empty() const noexcept {
+            return m_nodes.empty();
+        }
+
+        std::size_t size() const noexcept {
+            return m_nodes.size();
+        }
+
+        Value &front() const noexcept {
+            return static_cast<Value &>(*m_nodes.front());
+        }
+
+        void popFront() noexcept {
+            erase(front());
+        }
+
+    private:
+        static std::size_t parentOf(std::size_t index) noexcept {
+            return (index - 1) / D;
+        }
+
+        bool less(Node *left, Node *right) const noexcept {
+            return m_comp(static_cast<Value &>(*left), static_cast<Value &>(*right));
+        }
+
+        void place(std::size_t index, Node *node) noexcept {
+            m_nodes[index] = node;
+            node->m_index = index;
+        }
+
+        /* 空出位置依次下移父节点, 最后才放入 node, 省去逐层交换 */
+        void siftUp(std::size_t index) noexcept {
+            Node *node = m_nodes[index];
+            while (index != 0) {
+                std::size_t parent = parentOf(index);
+                if (!less(node, m_nodes[parent])) {
+                    break;
+                }
+                place(index, m_nodes[parent]);
+                index = parent;
+            }
+            place(index, node);
+        }
+
+        void siftDown(std::size_t index) noexcept {
+            Node *node = m_nodes[index];
+            std::size_t size = m_nodes.size();
+            while (true) {
+                std::size_t first = index * D + 1;
+                if (first >= size) {
+                    break;
+                }
+                std::size_t last = std::min(first + D, size);
+                std::size_t best = first;
+                for (std::size_t child = first + 1; child < last; ++child) {
+                    if (less(m_nodes[child], m_nodes[best])) {
+                        best = child;
+                    }
+                }
+                if (!less(m_nodes[best], node)) {
+                    break;
+                }
+                place(index, m_nodes[best]);
+                index = best;
+            }
+            place(index, node);
+        }
+
+        std::vector<Node *> m_nodes;
+        Compare m_comp;
+    };
+
+} // namespace co_async
@@ -4,14 +4,25 @@
 #include <vector>
 #include <span>
 #include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <ctime>
+#include <limits>
 #include <sys/epoll.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #include "error_handling.hpp"
+#include "expected.hpp"
+#include "mpsc_queue.hpp"
+#include "ring_queue.hpp"
 #include "when_any.hpp"
 #include "when_all.hpp"
 
-#define TEST 0
-
 namespace co_async {
 
 using EpollEventMask = std::uint32_t;
@@ -21,131 +32,199 @@ struct EpollFilePromise : Promise<EpollEventMask> {
         return std::coroutine_handle<EpollFilePromise>::from_promise(*this);
     }
     EpollFilePromise& operator=(EpollFilePromise&&) = delete;
+};
 
-    inline ~EpollFilePromise();
+struct EpollFileAwaiter;
 
-    struct EpollFileAwaiter* m_epollAwaiter;
+/**
+ * 单个文件描述符在 epoll 中的注册状态
+ * fd 第一次被等待时 EPOLL_CTL_ADD, 之后每次等待只用 EPOLL_CTL_MOD 重新装填 EPOLLONESHOT,
+ * 直到 AsyncFile 关闭时才 EPOLL_CTL_DEL
+ */
+struct EpollFileEntry {
+    /* 当前正在等待该 fd 的 awaiter, 为空表示没有协程在等待 */
+    EpollFileAwaiter *m_waiter = nullptr;
+    /* 每次装填递增, 用于丢弃上一次装填遗留在缓冲区中的过期事件 */
+    std::uint32_t m_generation = 0;
+    bool m_registered = false;
+    /* 常驻监听者(例如 io_uring 的完成队列)的回调, 不计入 m_count */
+    void (*m_callback)(void *context) = nullptr;
+    void *m_context = nullptr;
+};
+
+/**
+ * 事件循环的系统调用计数, 用于衡量每次读写实际付出的内核开销
+ */
+struct EpollLoopStats {
+    std::size_t ctlCalls = 0;
+    std::size_t waitCalls = 0;
+    std::size_t events = 0;
+    /* 返回的事件数填满了缓冲区的次数, 说明批量大小不够 */
+    std::size_t fullWaits = 0;
+    /* 忙轮询模式下 0 超时的 epoll 调用次数, 以及其中取到事件的次数 */
+    std::size_t spinPolls = 0;
+    std::size_t spinHits = 0;
+
+    /* 每次 epoll_wait 平均取回的事件数, 用于确定批量大小 */
+    double eventsPerWait() const noexcept {
+        return waitCalls ? (double) events / (double) waitCalls : 0.0;
+    }
 };
 
-#if TEST
 struct EpollLoop {
+private:
+    int m_epoll = checkError(epoll_create1(0));
+    size_t m_count = 0;
+    /* 每次 epoll_wait 取回事件的缓冲区, 填满时自动扩大, 直到 m_maxBatchSize */
+    std::vector<struct epoll_event> m_buffer = std::vector<struct epoll_event>(64);
+    std::size_t m_maxBatchSize = 4096;
+    /* dispatch 期间协程设置的批量大小, 不能在遍历 m_buffer 时改变它的大小, 等到 dispatch 结束后生效; 0 表示没有 */
+    std::size_t m_pendingBatchSize = 0;
+    bool m_dispatching = false;
+    /* 缓冲区被填满时立即以 0 超时再取一次, 而不是先走完一轮完整的循环 */
+    bool m_drain = false;
+    /* 待恢复的协程, 先进先出 */
+    RingQueue<std::coroutine_handle<>> m_queue;
+    /* 每轮循环最多从 m_queue 恢复的协程数, 用完后先查询一次 epoll */
+    std::size_t m_budget = 256;
+    /* 其他线程通过 post 提交的协程, 由 m_wakeFd 唤醒本线程后转入 m_queue */
+    MpscQueue<std::coroutine_handle<>> m_remote;
+    int m_wakeFd = checkError(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+    /* 内核是否支持 epoll_pwait2 (5.11 起), 第一次返回 ENOSYS 后所有循环都不再尝试 */
+    static inline std::atomic<bool> s_hasPwait2{true};
+    /* 阻塞等待之前先以 0 超时轮询的时长, 0 表示不轮询 */
+    std::chrono::nanoseconds m_spin{0};
+    /* 首次注册的 socket 设置的 SO_BUSY_POLL 微秒数, 0 表示不设置 */
+    int m_socketBusyPoll = 0;
+    /* 以 fd 为下标的注册表 */
+    std::vector<EpollFileEntry> m_files;
+    EpollLoopStats m_stats;
+
+    EpollFileEntry &fileEntry(int fileNo) {
+        if (static_cast<std::size_t>(fileNo) >= m_files.size()) {
+            m_files.resize(fileNo + 1);
+        }
+        return m_files[fileNo];
+    }
+
+    /* epoll_event.data 中同时保存 fd 与装填代数 */
+    static std::uint64_t packEventData(int fileNo, std::uint32_t generation) noexcept {
+        return (std::uint64_t) generation << 32 | (std::uint32_t) fileNo;
+    }
+
+    inline int rearm(int control, int fileNo, struct epoll_event &event);
+    inline void dispatch(int count);
+    inline bool runQueue();
+    inline int wait(std::optional<std::chrono::nanoseconds> timeout);
+    inline int poll(std::optional<std::chrono::nanoseconds> timeout);
+    inline static void onWake(void *context);
 public:
+    EpollLoop() {
+        addWatcher(m_wakeFd, EPOLLIN, onWake, this);
+    }
 
-    inline bool addListener(EpollFilePromise& promise);
-    inline void removeListener(int Fileno);
-    inline bool run(std::optional<std::chrono::system_clock::duration> timeout = std::nullopt);
+    inline bool addListener(EpollFileAwaiter& awaiter);
+    inline void removeListener(EpollFileAwaiter& awaiter);
+    inline void removeFile(int fileNo);
+    inline void addWatcher(int fileNo, EpollEventMask events,
+                           void (*callback)(void *context), void *context);
+    inline void removeWatcher(int fileNo);
+    inline bool run(std::optional<std::chrono::nanoseconds> timeout = std::nullopt);
 
-    EpollLoop &operator=(EpollLoop &&) = delete;
-    ~EpollLoop() {
-        close(m_epoll);
+    bool hasEvent() {
+        return m_count != 0 || hasReady();
     }
-private:
-    int m_epoll = checkError(epoll_create1(0));
-    struct epoll_event event_buffer[64];
-};
 
-struct EpollFileAwaiter {
     /**
-     * 假设永远需要被挂起
-     * @return
+     * 是否有等待在下一轮恢复的协程, 包括被取消、等待回调的等待者
      */
-    bool await_ready() const noexcept { return false; }
+    bool hasReady() const noexcept {
+        return !m_queue.empty() || CancelState::hasPending();
+    }
 
     /**
-     * 当调用co_await时会使用这个函数
-     * 决定如何挂起当前协程, 并将控制权交给其他部分(例如事件循环或调度器)
-     * @param coroutine
+     * 只能在本循环的线程调用, 在下一轮循环中恢复 coroutine
      */
-    void await_suspend(std::coroutine_handle<EpollFilePromise> coroutine) {
-        auto &promise = coroutine.promise();
-        promise.m_epollAwaiter = this;
-        loop.addListener(promise);
+    void schedule(std::coroutine_handle<> coroutine) {
+        m_queue.push(coroutine);
     }
 
     /**
-     * 异步操作完成并且协程被恢复时被调用
-     * 返回协程结果或抛出异常
+     * 可以在任意线程调用, 让本循环所在的线程恢复 coroutine
+     * 投递不会让循环保持运行, 调用者需要事先 retain, 在协程里再 release
      */
-    EpollEventMask await_resume() const noexcept {}
+    void post(std::coroutine_handle<> coroutine) {
+        if (m_remote.push(coroutine)) {
+            /* 队列由空变为非空时才需要唤醒, 其余的投递会被同一次唤醒一并取走 */
+            std::uint64_t one = 1;
+            [[maybe_unused]] auto res = write(m_wakeFd, &one, sizeof(one));
+        }
+    }
 
-    EpollLoop& loop;
-    int mFileno;
-    EpollEventMask mEvents;
-    EpollEventMask mResumeEvents;
-};
+    /**
+     * 不经过 epoll 的挂起操作(例如已提交给 io_uring 的请求)也要计入 m_count,
+     * 保证它们完成之前循环不会退出
+     */
+    void retain() noexcept {
+        ++m_count;
+    }
 
-bool EpollLoop::addListener(EpollFilePromise& promise) {
-    struct epoll_event event{};
-    event.events = promise.m_epollAwaiter->mEvents | EPOLLONESHOT; // 监听可读事件
-    event.data.ptr = &promise; // 指向用户数据
-    checkError(epoll_ctl(m_epoll, EPOLL_CTL_ADD, promise.m_epollAwaiter->mFileno, &event));
-}
+    void release() noexcept {
+        --m_count;
+    }
 
-void EpollLoop::removeListener(int fileNo) {
-    checkError(epoll_ctl(m_epoll, EPOLL_CTL_DEL, fileNo, nullptr));
-}
+    EpollLoopStats const &stats() const noexcept {
+        return m_stats;
+    }
 
-/**
- * 进入事件循环, 等待和处理 I/O 事件
- * 调用 epoll_wait 函数, 等待指定的时间(timeout)以获取 I/O 事件
- * 处理返回的事件, 将每个事件的 data.ptr 字段转换为 EpollFilePromise
- * 并调用其对应的协程句柄的 resume() 方法, 恢复协程的执行。
- * @param timeout
- */
-bool EpollLoop::run(std::optional<std::chrono::system_clock::duration> timeout) {
-    /* 逐个恢复挂起的协程 */
-    /*
-    while (!m_queue.empty()) {
-        auto task = m_queue.back();
-        m_queue.pop_back();
-        task.resume();
-    }
-    if (m_count == 0) return false;
-    */
-    int timeoutMS = -1;
-    if (timeout) {
-        timeoutMS = std::chrono::duration_cast<std::chrono::milliseconds>(*timeout).count();
-    }
-    /* 等待事件发生 */
-    int res = checkError(epoll_wait(m_epoll, event_buffer, std::size(event_buffer), timeoutMS));
-    /* 将发生的事件信息写入相应的 promise.m_epollAwaiter->m_resumeEvents */
-    for (int i = 0; i < res; i++) {
-        auto &event = event_buffer[i];
-        auto &promise = *(EpollFilePromise *) event.data.ptr;
-        promise.m_epollAwaiter->mResumeEvents = event.events;
-    }
-    /* 恢复所有相关的协程 */
-    for (int i = 0; i < res; i++) {
-        auto &event = event_buffer[i];
-        auto &promise = *(EpollFilePromise *) event.data.ptr;
-        std::coroutine_handle<EpollFilePromise>::from_promise(promise).resume();
+    std::size_t batchSize() const noexcept {
+        return m_pendingBatchSize ? m_pendingBatchSize : m_buffer.size();
     }
-    return true;
-}
 
-EpollFilePromise::~EpollFilePromise() {
-    if (m_epollAwaiter) [[likely]] {
-        m_epollAwaiter->loop.removeListener(m_epollAwaiter->mFileno);
+    /**
+     * 设置当前批量大小, 上限随之至少提高到 size
+     * 在被 dispatch 恢复的协程中调用时, 推迟到这一批事件处理完再生效
+     */
+    void setBatchSize(std::size_t size) {
+        if (size == 0) size = 1;
+        if (m_dispatching) {
+            m_pendingBatchSize = size;
+        } else {
+            m_buffer.resize(size);
+        }
+        if (m_maxBatchSize < size) m_maxBatchSize = size;
     }
-}
 
-#else
-struct EpollLoop {
-private:
-    int m_epoll = checkError(epoll_create1(0));
-    size_t m_count = 0;
-    struct epoll_event m_buffer[64];
-    std::vector<std::coroutine_handle<>> m_queue;
-public:
-    inline bool addListener(EpollFilePromise& promise, int control);
-    inline void removeListener(int Fileno);
-    inline bool run(std::optional<std::chrono::system_clock::duration> timeout = std::nullopt);
+    /**
+     * 设置自动扩大的上限, 等于当前批量大小时即关闭自动扩大
+     */
+    void setMaxBatchSize(std::size_t size) noexcept {
+        m_maxBatchSize = std::max(size, batchSize());
+    }
 
-    bool hasEvent() {
-        return m_count != 0;
+    void setDrain(bool drain) noexcept {
+        m_drain = drain;
+    }
+
+    /**
+     * 设置每轮循环最多恢复的就绪协程数, 超出的留到查询过 I/O 之后的下一轮
+     */
+    void setBudget(std::size_t budget) noexcept {
+        m_budget = std::max<std::size_t>(budget, 1);
+    }
+
+    /**
+     * 忙轮询模式: 每次阻塞等待之前先空转最多 spin 时长, 用一个核心换取微秒级的唤醒延迟
+     * @param socketBusyPoll 大于 0 时对之后首次注册的 socket 设置 SO_BUSY_POLL (微秒),
+     * 让内核在读取时直接轮询网卡队列; 对非 socket 或者权限不足时静默忽略
+     */
+    void setBusyPoll(std::chrono::nanoseconds spin, int socketBusyPoll = 0) noexcept {
+        m_spin = std::max(spin, std::chrono::nanoseconds::zero());
+        m_socketBusyPoll = socketBusyPoll;
     }
 
     ~EpollLoop() {
+        close(m_wakeFd);
         close(m_epoll);
     }
 
@@ -156,78 +235,346 @@ struct EpollFileAwaiter {
     EpollFileAwaiter(EpollLoop& loop, int fileno, EpollEventMask event) :
             m_loop(loop), fileno(fileno), m_events(event){};
 
+    EpollFileAwaiter(EpollFileAwaiter &&) = delete;
+
+    /**
+     * 协程在等待期间被销毁时(例如 when_any 中落败的一方), 从注册表中撤销等待
+     * 不需要任何系统调用, 内核中残留的一次性装填触发时会被当作过期事件丢弃
+     */
+    ~EpollFileAwaiter() {
+        if (m_coroutine) {
+            m_loop.removeListener(*this);
+        }
+    }
+
     bool await_ready() const noexcept { return false; }
 
-    void await_suspend(std::coroutine_handle<EpollFilePromise> coroutine) {
-        auto &promise = coroutine.promise();
-        promise.m_epollAwaiter = this;
-        if (!m_loop.addListener(promise, control)) {
-            promise.m_epollAwaiter = nullptr;
-            coroutine.resume();
+    /**
+     * 注册失败时(例如普通文件不支持 epoll)不挂起, 视为立即就绪
+     * 协程关联的 CancelToken 已经取消时也不挂起, 直接抛出 operation_canceled
+     */
+    template <class P>
+    bool await_suspend(std::coroutine_handle<P> coroutine) {
+        m_arena.save();
+        CancelToken token = cancelTokenOf(coroutine);
+        if (token.cancelled()) [[unlikely]] {
+            m_cancelled = true;
+            return false;
+        }
+        m_coroutine = coroutine;
+        if (!m_loop.addListener(*this)) {
+            m_coroutine = nullptr;
+            m_resumeEvents = m_events;
+            return false;
         }
+        m_cancelNode.link(token.state(), &EpollFileAwaiter::onCancel, this);
+        return true;
     }
 
-    EpollEventMask await_resume() const noexcept {
+    EpollEventMask await_resume() {
+        m_arena.restore();
+        m_cancelNode.unlink();
+        if (m_cancelled) [[unlikely]] {
+            throwCancelled();
+        }
         return m_resumeEvents;
     }
 
+    /* 取消时撤销等待, 内核中残留的装填与协程被销毁时一样当作过期事件丢弃 */
+    static void onCancel(void *context) {
+        auto &awaiter = *static_cast<EpollFileAwaiter *>(context);
+        awaiter.m_loop.removeListener(awaiter);
+        awaiter.m_cancelled = true;
+        FrameArena::resume(std::exchange(awaiter.m_coroutine, nullptr));
+    }
+
     EpollLoop& m_loop;
-    int control = EPOLL_CTL_ADD;
     int fileno;
     EpollEventMask m_events;
-    EpollEventMask m_resumeEvents;
+    EpollEventMask m_resumeEvents = 0;
+    std::coroutine_handle<> m_coroutine;
+    CancelNode m_cancelNode;
+    ArenaResume m_arena;
+    bool m_cancelled = false;
 };
 
-EpollFilePromise::~EpollFilePromise() {
-    if (m_epollAwaiter) {
-        m_epollAwaiter->m_loop.removeListener(m_epollAwaiter->fileno);
+/**
+ * try_ 版本使用的等待者: 被取消时返回 errc::operation_canceled, 不抛出异常
+ */
+struct TryEpollFileAwaiter : EpollFileAwaiter {
+    using EpollFileAwaiter::EpollFileAwaiter;
+
+    Expected<EpollEventMask> await_resume() noexcept {
+        m_arena.restore();
+        m_cancelNode.unlink();
+        if (m_cancelled) [[unlikely]] {
+            return std::make_error_code(std::errc::operation_canceled);
+        }
+        return m_resumeEvents;
     }
+};
+
+int EpollLoop::rearm(int control, int fileNo, struct epoll_event &event) {
+    ++m_stats.ctlCalls;
+    return epoll_ctl(m_epoll, control, fileNo, &event);
 }
 
-bool EpollLoop::addListener(EpollFilePromise& promise, int control) {
+/**
+ * 已注册过的 fd 只需 EPOLL_CTL_MOD 重新装填, 未注册的才 EPOLL_CTL_ADD
+ * 注册表与内核不一致时(fd 被关闭后复用, 或在外部被注册过)换另一种操作重试一次
+ * 同一个 fd 同时只允许一个协程等待
+ */
+bool EpollLoop::addListener(EpollFileAwaiter& awaiter) {
+    auto &entry = fileEntry(awaiter.fileno);
+    if (entry.m_waiter || entry.m_callback) return false;
     struct epoll_event event{};
-    event.events = promise.m_epollAwaiter->m_events;
-    event.data.ptr = &promise;
-    int res = epoll_ctl(m_epoll, control, promise.m_epollAwaiter->fileno, &event);
-    if (res == -1) return false;
-    else if (control == EPOLL_CTL_ADD) m_count++;
+    event.events = awaiter.m_events | EPOLLONESHOT;
+    event.data.u64 = packEventData(awaiter.fileno, ++entry.m_generation);
+    int control = entry.m_registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    if (!entry.m_registered && m_socketBusyPoll > 0) {
+        setsockopt(awaiter.fileno, SOL_SOCKET, SO_BUSY_POLL,
+                   &m_socketBusyPoll, sizeof(m_socketBusyPoll));
+    }
+    if (rearm(control, awaiter.fileno, event) == -1) {
+        if (control == EPOLL_CTL_MOD && errno == ENOENT) {
+            control = EPOLL_CTL_ADD;
+        } else if (control == EPOLL_CTL_ADD && errno == EEXIST) {
+            control = EPOLL_CTL_MOD;
+        } else {
+            return false;
+        }
+        if (rearm(control, awaiter.fileno, event) == -1) return false;
+    }
+    entry.m_registered = true;
+    entry.m_waiter = &awaiter;
+    ++m_count;
     return true;
 }
 
-void EpollLoop::removeListener(int Fileno) {
-    checkError(epoll_ctl(m_epoll, EPOLL_CTL_DEL, Fileno, nullptr));
-    --m_count;
+void EpollLoop::removeListener(EpollFileAwaiter& awaiter) {
+    auto &entry = m_files[awaiter.fileno];
+    if (entry.m_waiter == &awaiter) {
+        entry.m_waiter = nullptr;
+        --m_count;
+    }
 }
 
-bool EpollLoop::run(std::optional<std::chrono::system_clock::duration> timeout) {
-    /* 逐个恢复挂起的协程 */
-    while (!m_queue.empty()) {
-        auto task = m_queue.back();
-        m_queue.pop_back();
-        task.resume();
+/**
+ * 文件关闭前调用, 真正地把 fd 从 epoll 中删除
+ */
+void EpollLoop::removeFile(int fileNo) {
+    if (static_cast<std::size_t>(fileNo) >= m_files.size()) return;
+    auto &entry = m_files[fileNo];
+    if (entry.m_registered) {
+        ++m_stats.ctlCalls;
+        epoll_ctl(m_epoll, EPOLL_CTL_DEL, fileNo, nullptr);
+        entry.m_registered = false;
+    }
+}
+
+/**
+ * 注册一个常驻的、水平触发的内部 fd, 事件发生时调用 callback(context)
+ * 它不会恢复任何协程, 也不会让循环保持运行
+ */
+void EpollLoop::addWatcher(int fileNo, EpollEventMask events,
+                           void (*callback)(void *context), void *context) {
+    auto &entry = fileEntry(fileNo);
+    struct epoll_event event{};
+    event.events = events;
+    event.data.u64 = packEventData(fileNo, entry.m_generation);
+    ++m_stats.ctlCalls;
+    checkError(epoll_ctl(m_epoll, EPOLL_CTL_ADD, fileNo, &event));
+    entry.m_registered = true;
+    entry.m_callback = callback;
+    entry.m_context = context;
+}
+
+void EpollLoop::removeWatcher(int fileNo) {
+    auto &entry = m_files[fileNo];
+    entry.m_callback = nullptr;
+    entry.m_context = nullptr;
+    removeFile(fileNo);
+}
+
+/**
+ * 先调用上一轮中积攒的取消回调, 被取消的等待者在这里恢复, 见 CancelState::cancel
+ * 再按先进先出的顺序恢复 m_queue 中的协程
+ * 只处理本轮开始时已经就绪的, 并且不超过 m_budget 个: 不断重新排队的协程(例如 yield)
+ * 不能饿死 I/O 和之后到达的协程
+ * @return 是否恢复了协程
+ */
+bool EpollLoop::runQueue() {
+    bool cancelled = CancelState::runPending();
+    std::size_t count = std::min(m_queue.size(), m_budget);
+    for (std::size_t i = 0; i < count; ++i) {
+        FrameArena::resume(m_queue.pop());
+    }
+    return cancelled || count != 0;
+}
+
+/**
+ * 先清空 eventfd 的计数再取队列: 在这之后使队列由空变为非空的投递一定会再次写入 eventfd
+ * 有生产者占了位置还没写完时它不会再写 eventfd, 由本线程写入, 下一轮再取
+ */
+void EpollLoop::onWake(void *context) {
+    auto &loop = *static_cast<EpollLoop *>(context);
+    std::uint64_t count;
+    [[maybe_unused]] auto res = read(loop.m_wakeFd, &count, sizeof(count));
+    bool pending = loop.m_remote.popAll([&loop](std::coroutine_handle<> coroutine) {
+        loop.m_queue.push(coroutine);
+    });
+    if (pending) {
+        std::uint64_t one = 1;
+        res = write(loop.m_wakeFd, &one, sizeof(one));
+    }
+}
+
+bool EpollLoop::run(std::optional<std::chrono::nanoseconds> timeout) {
+    /* 恢复的协程可能添加了更早的定时器, 调用者算出的超时已经过时, 不能阻塞 */
+    if (runQueue()) {
+        timeout = std::chrono::nanoseconds::zero();
+    }
+    /* 没有注册 fd 但给出了超时(还有定时器)时也要等待, 期间可以被 post 唤醒 */
+    if (m_count == 0 && !timeout) return false;
+    while (true) {
+        /* 等待事件发生 */
+        int res = wait(timeout);
+        ++m_stats.waitCalls;
+        m_stats.events += res;
+        m_dispatching = true;
+        dispatch(res);
+        m_dispatching = false;
+        if (m_pendingBatchSize) {
+            m_buffer.resize(std::exchange(m_pendingBatchSize, 0));
+            break;
+        }
+        if (static_cast<std::size_t>(res) < m_buffer.size()) break;
+        /* 缓冲区被填满, 内核中很可能还有积压的事件 */
+        ++m_stats.fullWaits;
+        if (m_buffer.size() < m_maxBatchSize) {
+            m_buffer.resize(std::min(m_buffer.size() * 2, m_maxBatchSize));
+        }
+        if (!m_drain || m_count == 0) break;
+        timeout = std::chrono::nanoseconds::zero();
+    }
+    return true;
+}
+
+/**
+ * 开启忙轮询时, 先以 0 超时反复查询, 直到取到事件、轮询时长用完或者定时器到期
+ * 之后才用剩余的超时阻塞等待
+ */
+int EpollLoop::wait(std::optional<std::chrono::nanoseconds> timeout) {
+    using namespace std::chrono;
+    if (m_spin == nanoseconds::zero() || (timeout && *timeout <= nanoseconds::zero())) {
+        return poll(timeout);
+    }
+    auto start = steady_clock::now();
+    auto spin = m_spin;
+    if (timeout) {
+        spin = std::min(spin, *timeout);
+    }
+    nanoseconds elapsed;
+    do {
+        int res = poll(nanoseconds::zero());
+        ++m_stats.spinPolls;
+        if (res != 0) {
+            ++m_stats.spinHits;
+            return res;
+        }
+        elapsed = steady_clock::now() - start;
+    } while (elapsed < spin);
+    if (timeout) {
+        /* 剩余超时为负时 poll 会按 0 处理 */
+        *timeout -= elapsed;
+    }
+    return poll(timeout);
+}
+
+/**
+ * 优先使用纳秒精度的 epoll_pwait2, 不必把定时器的超时截断到毫秒:
+ * 向下截断会让不足 1ms 的等待变成 0 而空转, 超过 1ms 的等待提前醒来
+ * 旧内核上退化为 epoll_wait, 超时向上取整到毫秒, 宁可晚醒一点也不空转
+ * 被信号或者 io_uring 的 task_work 打断(EINTR)时当作没有事件, 下一轮重新计算超时
+ */
+int EpollLoop::poll(std::optional<std::chrono::nanoseconds> timeout) {
+    using namespace std::chrono;
+    if (timeout && *timeout < nanoseconds::zero()) {
+        timeout = nanoseconds::zero();
+    }
+    if (s_hasPwait2.load(std::memory_order_relaxed)) {
+        struct timespec spec{}, *specPtr = nullptr;
+        if (timeout) {
+            auto ns = timeout->count();
+            spec.tv_sec = ns / 1000000000;
+            spec.tv_nsec = ns % 1000000000;
+            specPtr = &spec;
+        }
+        int res = (int) syscall(SYS_epoll_pwait2, m_epoll, m_buffer.data(),
+                                (int) m_buffer.size(), specPtr, nullptr, 0);
+        if (res != -1 || errno != ENOSYS) {
+            if (res == -1 && errno == EINTR) return 0;
+            return checkError(res);
+        }
+        s_hasPwait2.store(false, std::memory_order_relaxed);
     }
-    if (m_count == 0) return false;
     int timeoutMS = -1;
     if (timeout) {
-        timeoutMS = std::chrono::duration_cast<std::chrono::milliseconds>(*timeout).count();
+        timeoutMS = (int) std::min<milliseconds::rep>(ceil<milliseconds>(*timeout).count(),
+                                                      std::numeric_limits<int>::max());
     }
-    /* 等待事件发生 */
-    int res = checkError(epoll_wait(m_epoll, m_buffer, std::size(m_buffer), timeoutMS));
-    /* 将发生的事件信息写入相应的 promise.m_epollAwaiter->m_resumeEvents */
-    for (int i = 0; i < res; i++) {
+    int res = epoll_wait(m_epoll, m_buffer.data(), m_buffer.size(), timeoutMS);
+    if (res == -1 && errno == EINTR) return 0;
+    return checkError(res);
+}
+
+/**
+ * 恢复所有相关的协程
+ * 每次都重新查注册表: 前面恢复的协程可能已经撤销或重新装填了后面的 fd
+ */
+void EpollLoop::dispatch(int count) {
+    for (int i = 0; i < count; i++) {
         auto &event = m_buffer[i];
-        auto &promise = *(EpollFilePromise *) event.data.ptr;
-        promise.m_epollAwaiter->m_resumeEvents = event.events;
+        auto &entry = m_files[(std::uint32_t) event.data.u64];
+        if (auto callback = entry.m_callback) {
+            callback(entry.m_context);
+            continue;
+        }
+        auto *awaiter = entry.m_waiter;
+        if (!awaiter || entry.m_generation != (std::uint32_t) (event.data.u64 >> 32)) {
+            continue;
+        }
+        entry.m_waiter = nullptr;
+        --m_count;
+        awaiter->m_resumeEvents = event.events;
+        FrameArena::resume(std::exchange(awaiter->m_coroutine, nullptr));
     }
-    /* 恢复所有相关的协程 */
-    for (int i = 0; i < res; i++) {
-        auto &event = m_buffer[i];
-        auto &promise = *(EpollFilePromise *) event.data.ptr;
-        std::coroutine_handle<EpollFilePromise>::from_promise(promise).resume();
+}
+
+/**
+ * 让出线程, 排到就绪队列的末尾, 在下一轮循环中继续
+ * 长时间的计算可以周期性地 co_await yield(loop), 避免饿死同一循环上的 I/O
+ */
+struct YieldAwaiter {
+    bool await_ready() const noexcept {
+        return false;
     }
-    return true;
+
+    void await_suspend(std::coroutine_handle<> coroutine) {
+        m_loop.schedule(coroutine);
+    }
+
+    void await_resume() const noexcept {
+        m_arena.restore();
+    }
+
+    EpollLoop &m_loop;
+    ArenaResume m_arena;
+};
+
+inline YieldAwaiter yield(EpollLoop &loop) {
+    return YieldAwaiter{loop};
 }
-#endif
 
 /**
  * 管理异步文件描述符
@@ -239,17 +586,22 @@ public:
 
     explicit AsyncFile(int fileNo) noexcept : m_fileNo(fileNo) {}
 
-    AsyncFile(AsyncFile &&that) noexcept : m_fileNo(that.m_fileNo) {
+    AsyncFile(AsyncFile &&that) noexcept : m_fileNo(that.m_fileNo), m_loop(that.m_loop) {
         that.m_fileNo = -1;
+        that.m_loop = nullptr;
     }
 
     AsyncFile &operator=(AsyncFile &&that) noexcept {
         std::swap(m_fileNo, that.m_fileNo);
+        std::swap(m_loop, that.m_loop);
         return *this;
     }
 
     ~AsyncFile() {
-        if (m_fileNo != -1) close(m_fileNo);
+        if (m_fileNo != -1) {
+            detachLoop();
+            close(m_fileNo);
+        }
     }
 
     int fileNo() const noexcept {
@@ -257,6 +609,7 @@ public:
     }
 
     int releaseOwnership() noexcept {
+        detachLoop();
         int ret = m_fileNo;
         m_fileNo = -1;
         return ret;
@@ -266,8 +619,23 @@ public:
         int attr = 1;
         checkError(ioctl(fileNo(), FIONBIO, &attr));
     }
+
+    /**
+     * 记录该文件在哪个事件循环中注册过, 关闭时由它负责 EPOLL_CTL_DEL
+     */
+    void attachLoop(EpollLoop &loop) noexcept {
+        m_loop = &loop;
+    }
 private:
+    void detachLoop() noexcept {
+        if (m_loop) {
+            m_loop->removeFile(m_fileNo);
+            m_loop = nullptr;
+        }
+    }
+
     int m_fileNo;
+    EpollLoop *m_loop = nullptr;
 };
 
 
@@ -280,8 +648,18 @@ private:
  */
 inline Task<EpollEventMask, EpollFilePromise>
 wait_file_event(EpollLoop& loop, AsyncFile& file, EpollEventMask events) {
+        file.attachLoop(loop);
         co_return co_await EpollFileAwaiter(loop, file.fileNo(), events);
 }
+
+/**
+ * 与 wait_file_event 相同, 但被取消时返回 errc::operation_canceled 而不是抛出异常
+ */
+inline Task<Expected<EpollEventMask>>
+try_wait_file_event(EpollLoop& loop, AsyncFile& file, EpollEventMask events) {
+    file.attachLoop(loop);
+    co_return co_await TryEpollFileAwaiter(loop, file.fileNo(), events);
+}
 /**
  * 同步读取文件内容到提供的缓冲区
  * @param file 要读取的文件
@@ -313,8 +691,97 @@ inline Task<size_t> read_file(EpollLoop& loop, AsyncFile& file,
 
 inline Task<size_t> write_file(EpollLoop& loop, AsyncFile& file,
                                std::span<char const> buffer) {
-    co_await wait_file_event(loop, file, EPOLLIN | EPOLLRDHUP);
+    co_await wait_file_event(loop, file, EPOLLOUT);
     auto len = writeFileSync(file, buffer);
     co_return len;
 }
-}
\ No newline at end of file
+/**
+ * 以下 try_ 版本不抛出异常, 错误通过 Expected 返回, 用于连接重置等错误常见的热路径
+ * 与 readFileSync 一样, EWOULDBLOCK 视为读到 0 字节
+ */
+inline Expected<size_t> tryReadFileSync(AsyncFile& file, std::span<char> buffer) noexcept {
+    ssize_t res = read(file.fileNo(), buffer.data(), buffer.size());
+    if (res == -1) [[unlikely]] {
+        if (errno != EWOULDBLOCK) return lastError();
+        res = 0;
+    }
+    return static_cast<size_t>(res);
+}
+
+inline Expected<size_t> tryWriteFileSync(AsyncFile& file, std::span<char const> buffer) noexcept {
+    ssize_t res = write(file.fileNo(), buffer.data(), buffer.size());
+    if (res == -1) [[unlikely]] {
+        if (errno != EWOULDBLOCK) return lastError();
+        res = 0;
+    }
+    return static_cast<size_t>(res);
+}
+
+inline Task<Expected<size_t>> try_read_file(EpollLoop& loop, AsyncFile& file,
+                                            std::span<char> buffer) {
+    auto events = co_await try_wait_file_event(loop, file, EPOLLIN | EPOLLRDHUP);
+    if (!events) [[unlikely]] {
+        co_return events.error();
+    }
+    co_return tryReadFileSync(file, buffer);
+}
+
+inline Task<Expected<size_t>> try_write_file(EpollLoop& loop, AsyncFile& file,
+                                             std::span<char const> buffer) {
+    auto events = co_await try_wait_file_event(loop, file, EPOLLOUT);
+    if (!events) [[unlikely]] {
+        co_return events.error();
+    }
+    co_return tryWriteFileSync(file, buffer);
+}
+
+/**
+ * 从非阻塞的监听 socket 接受一个连接, 新连接同样是非阻塞的
+ * @param addr 可选, 用于取得对端地址, 与 accept4 的参数相同
+ */
+inline Task<Expected<AsyncFile>> try_accept(EpollLoop& loop, AsyncFile& listener,
+                                            struct sockaddr *addr = nullptr,
+                                            socklen_t *addrLen = nullptr) {
+    while (true) {
+        int fileNo = accept4(listener.fileNo(), addr, addrLen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fileNo != -1) {
+            co_return AsyncFile(fileNo);
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            co_return lastError();
+        }
+        if (errno != EINTR) {
+            auto events = co_await try_wait_file_event(loop, listener, EPOLLIN);
+            if (!events) [[unlikely]] {
+                co_return events.error();
+            }
+        }
+    }
+}
+
+/**
+ * 在非阻塞的 socket 上发起连接, 连接建立或失败后返回
+ */
+inline Task<Expected<void>> try_connect(EpollLoop& loop, AsyncFile& file,
+                                        struct sockaddr const *addr, socklen_t addrLen) {
+    if (connect(file.fileNo(), addr, addrLen) == 0) {
+        co_return {};
+    }
+    if (errno != EINPROGRESS && errno != EINTR) {
+        co_return lastError();
+    }
+    auto events = co_await try_wait_file_event(loop, file, EPOLLOUT);
+    if (!events) [[unlikely]] {
+        co_return events.error();
+    }
+    int error = 0;
+    socklen_t errorLen = sizeof(error);
+    if (getsockopt(file.fileNo(), SOL_SOCKET, SO_ERROR, &error, &errorLen) == -1) {
+        co_return lastError();
+    }
+    if (error != 0) {
+        co_return std::error_code(error, std::system_category());
+    }
+    co_return {};
+}
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cerrno>
+#include <coroutine>
+#include <exception>
+#include <new>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include "task.hpp"
+
+namespace co_async {
+
+    /**
+     * 不抛异常的错误通道: 保存一个值或者一个 std::error_code
+     * 连接重置这类经常发生的错误通过它返回, 不需要构造 std::system_error, 也不经过 exception_ptr
+     *
+     *     auto n = co_await try_read_file(loop, file, buffer);
+     *     if (!n) {
+     *         // n.error() == std::errc::connection_reset ...
+     *     }
+     */
+    template <class T>
+    struct [[nodiscard]] Expected {
+        Expected(T value) noexcept(std::is_nothrow_move_constructible_v<T>)
+                : mStorage(std::in_place_index<0>, std::move(value)) {}
+
+        Expected(std::error_code error) noexcept
+                : mStorage(std::in_place_index<1>, error) {}
+
+        bool hasValue() const noexcept {
+            return mStorage.index() == 0;
+        }
+
+        explicit operator bool() const noexcept {
+            return hasValue();
+        }
+
+        /**
+         * 没有值时才抛出 std::system_error, 用于不关心错误种类的调用方
+         */
+        T &value() & {
+            checkValue();
+            return *std::get_if<0>(&mStorage);
+        }
+
+        T const &value() const & {
+            checkValue();
+            return *std::get_if<0>(&mStorage);
+        }
+
+        T value() && {
+            checkValue();
+            return std::move(*std::get_if<0>(&mStorage));
+        }
+
+        T &operator*() noexcept {
+            return *std::get_if<0>(&mStorage);
+        }
+
+        T const &operator*() const noexcept {
+            return *std::get_if<0>(&mStorage);
+        }
+
+        T *operator->() noexcept {
+            return std::get_if<0>(&mStorage);
+        }
+
+        T const *operator->() const noexcept {
+            return std::get_if<0>(&mStorage);
+        }
+
+        /* 有值时为空的 error_code */
+        std::error_code error() const noexcept {
+            if (auto *error = std::get_if<1>(&mStorage)) {
+                return *error;
+            }
+            return {};
+        }
+
+    private:
+        void checkValue() const {
+            if (!hasValue()) [[unlikely]] {
+                throw std::system_error(*std::get_if<1>(&mStorage));
+            }
+        }
+
+        std::variant<T, std::error_code> mStorage;
+    };
+
+    template <>
+    struct [[nodiscard]] Expected<void> {
+        Expected() noexcept = default;
+
+        Expected(std::error_code error) noexcept : mError(error) {}
+
+        bool hasValue() const noexcept {
+            return !mError;
+        }
+
+        explicit operator bool() const noexcept {
+            return hasValue();
+        }
+
+        void value() const {
+            if (mError) [[unlikely]] {
+                throw std::system_error(mError);
+            }
+        }
+
+        std::error_code error() const noexcept {
+            return mError;
+        }
+
+    private:
+        std::error_code mError;
+    };
+
+    /* 当前 errno 对应的 error_code */
+    inline std::error_code lastError() noexcept {
+        return std::error_code(errno, std::system_category());
+    }
+
+    /**
+     * 与 checkError 相同的约定(-1 表示失败), 但把错误作为返回值
+     */
+    template <class T>
+    Expected<T> expectError(T res) noexcept {
+        if (res == -1) [[unlikely]] {
+            return lastError();
+        }
+        return res;
+    }
+
+    /**
+     * Task<Expected<T>> 的 promise
+     * 协程体内漏出的 std::system_error(例如调用了 checkError) 和 std::bad_alloc 转换为错误码, 不经过 exception_ptr;
+     * 其他异常无法表示为错误码, 与普通 Task 一样保存下来, 在等待者中重新抛出
+     */
+    template <class T>
+    struct Promise<Expected<T>> : ArenaPromise, CancellablePromise {
+        auto initial_suspend() noexcept {
+            return InitialAwaiter{*this};
+        }
+
+        auto final_suspend() noexcept {
+            return Previous_awaiter(mPrevious);
+        }
+
+        void unhandled_exception() noexcept {
+            try {
+                throw;
+            } catch (std::system_error const &e) {
+                mResult.putValue(e.code());
+            } catch (std::bad_alloc const &) {
+                mResult.putValue(std::make_error_code(std::errc::not_enough_memory));
+            } catch (...) {
+                mException = std::current_exception();
+            }
+        }
+
+        void return_value(Expected<T> &&ret) noexcept(std::is_nothrow_move_constructible_v<Expected<T>>) {
+            mResult.putValue(std::move(ret));
+        }
+
+        void return_value(Expected<T> const &ret) {
+            mResult.putValue(ret);
+        }
+
+        Expected<T> result() {
+            if (mException) [[unlikely]] {
+                std::rethrow_exception(mException);
+            }
+            return mResult.moveValue();
+        }
+
+        auto get_return_object() {
+            return std::coroutine_handle<Promise>::from_promise(*this);
+        }
+
+        std::coroutine_handle<> mPrevious;
+        std::exception_ptr mException{};
+        Uninitialized<Expected<T>> mResult;
+
+        Promise &operator=(Promise &&) = delete;
+    };
+
+} // namespace co_async
@@ -0,0 +1,349 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "frame_pool.hpp"
+
+namespace co_async {
+
+    struct FrameArenaStats {
+        /* 从区域中分配的协程帧数与字节数 */
+        std::size_t frames = 0;
+        std::size_t bytes = 0;
+        /* 其中复用已释放的帧、没有移动指针的次数 */
+        std::size_t reused = 0;
+        /* 向 malloc 申请的块数 */
+        std::size_t chunks = 0;
+        /* 所有帧都释放之后整体回收的次数 */
+        std::size_t rewinds = 0;
+    };
+
+    /**
+     * 区域的实际存储, 由 FrameArena 和其中还活着的帧共同持有:
+     * FrameArena 先析构时, 最后一个帧释放时才归还内存
+     */
+    struct FrameArenaState {
+        explicit FrameArenaState(std::size_t chunkSize) noexcept : m_chunkSize(chunkSize) {}
+
+        FrameArenaState(FrameArenaState &&) = delete;
+
+        ~FrameArenaState() {
+            while (m_chunks) {
+                Chunk *next = m_chunks->m_next;
+                std::free(m_chunks);
+                m_chunks = next;
+            }
+        }
+
+        /**
+         * 优先取同一级中已经释放的帧, 没有时指针碰撞式分配, 当前块用完时申请一个新块
+         * 不超过 kMaxPooledSize 的帧按 FramePool 的分级向上取整, 释放后同级的帧可以原地复用
+         */
+        void *allocate(std::size_t size) {
+            void *pointer;
+            if (size <= kMaxPooledSize) {
+                std::size_t index = sizeClass(size);
+                size = (index + 1) * kGranularity;
+                if (FreeBlock *block = m_free[index]) {
+                    m_free[index] = block->m_next;
+                    ++m_stats.reused;
+                    pointer = block;
+                } else {
+                    pointer = bump(size);
+                }
+            } else {
+                pointer = bump((size + kAlignment - 1) & ~(kAlignment - 1));
+            }
+            ++m_live;
+            ++m_stats.frames;
+            m_stats.bytes += size;
+            return pointer;
+        }
+
+        /**
+         * 释放的帧挂到所在分级的空闲链表中, 长期存活的连接反复创建子协程时内存不会持续增长
+         * 超过 kMaxPooledSize 的帧不单独回收; 所有帧都释放后整个区域一次性回到起点, 下一个连接直接复用
+         */
+        void deallocate(void *pointer, std::size_t size) noexcept {
+            if (--m_live == 0) {
+                if (m_orphaned) {
+                    delete this;
+                } else {
+                    rewind();
+                }
+                return;
+            }
+            if (size <= kMaxPooledSize) {
+                std::size_t index = sizeClass(size);
+                auto *block = static_cast<FreeBlock *>(pointer);
+                block->m_next = m_free[index];
+                m_free[index] = block;
+            }
+        }
+
+        /**
+         * FrameArena 析构时调用
+         */
+        void orphan() noexcept {
+            if (m_live == 0) {
+                delete this;
+            } else {
+                m_orphaned = true;
+            }
+        }
+
+        std::size_t live() const noexcept {
+            return m_live;
+        }
+
+        FrameArenaStats const &stats() const noexcept {
+            return m_stats;
+        }
+
+    private:
+        static constexpr std::size_t kAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+        static constexpr std::size_t kGranularity = FramePool::kGranularity;
+        static constexpr std::size_t kMaxPooledSize = FramePool::kMaxPooledSize;
+        static constexpr std::size_t kClasses = kMaxPooledSize / kGranularity;
+
+        static_assert(kGranularity % kAlignment == 0);
+
+        struct FreeBlock {
+            FreeBlock *m_next;
+        };
+
+        static std::size_t sizeClass(std::size_t size) noexcept {
+            return size == 0 ? 0 : (size - 1) / kGranularity;
+        }
+
+        char *bump(std::size_t size) {
+            if (static_cast<std::size_t>(m_end - m_cursor) < size) {
+                grow(size);
+            }
+            char *pointer = m_cursor;
+            m_cursor += size;
+            return pointer;
+        }
+
+        struct alignas(kAlignment) Chunk {
+            Chunk *m_next;
+            std::size_t m_size;
+        };
+
+        void grow(std::size_t size) {
+            std::size_t capacity = std::max(m_chunkSize, size);
+            auto *chunk = static_cast<Chunk *>(std::malloc(sizeof(Chunk) + capacity));
+            if (chunk == nullptr) [[unlikely]] {
+                throw std::bad_alloc();
+            }
+            ++m_stats.chunks;
+            chunk->m_next = m_chunks;
+            chunk->m_size = capacity;
+            m_chunks = chunk;
+            m_cursor = reinterpret_cast<char *>(chunk + 1);
+            m_end = m_cursor + capacity;
+        }
+
+        /* 只保留最近申请的块, 其余的还给 malloc */
+        void rewind() noexcept {
+            ++m_stats.rewinds;
+            m_free.fill(nullptr);
+            if (m_chunks == nullptr) {
+                return;
+            }
+            while (Chunk *next = m_chunks->m_next) {
+                m_chunks->m_next = next->m_next;
+                std::free(next);
+            }
+            m_cursor = reinterpret_cast<char *>(m_chunks + 1);
+            m_end = m_cursor + m_chunks->m_size;
+        }
+
+        Chunk *m_chunks = nullptr;
+        std::array<FreeBlock *, kClasses> m_free{};
+        char *m_cursor = nullptr;
+        char *m_end = nullptr;
+        std::size_t m_chunkSize;
+        std::size_t m_live = 0;
+        bool m_orphaned = false;
+        FrameArenaStats m_stats;
+    };
+
+    /**
+     * 协程帧的区域分配器, 一般每个连接一个
+     * 通过 bind 创建的顶层 Task 以及它运行期间创建的所有子协程帧(包括 when_all/when_any 的辅助协程)
+     * 都从区域中以指针碰撞的方式分配, 释放的帧按大小分级挂在空闲链表中供后续同级的帧复用,
+     * 全部释放后区域整体回收
+     * 区域只能在一个线程中使用
+     *
+     *     FrameArena arena;
+     *     auto task = arena.bind([&] { return handleConnection(loop, std::move(file)); });
+     *     co_await task;
+     */
+    struct FrameArena {
+        explicit FrameArena(std::size_t chunkSize = 16 * 1024)
+                : m_state(new FrameArenaState(chunkSize)) {}
+
+        FrameArena(FrameArena &&) = delete;
+
+        ~FrameArena() {
+            m_state->orphan();
+        }
+
+        /**
+         * 调用 factory 创建顶层任务, 期间分配的协程帧来自本区域
+         * 之后任务每次恢复运行时都会重新以本区域为当前区域
+         */
+        template <class F>
+        auto bind(F &&factory) {
+            Scope scope(m_state);
+            return std::forward<F>(factory)();
+        }
+
+        /* 还没有释放的帧数 */
+        std::size_t live() const noexcept {
+            return m_state->live();
+        }
+
+        FrameArenaStats const &stats() const noexcept {
+            return m_state->stats();
+        }
+
+        /**
+         * 当前线程正在运行的协程所属的区域, 不在任何区域中时为空
+         */
+        static FrameArenaState *current() noexcept {
+            return tCurrent;
+        }
+
+        static void setCurrent(FrameArenaState *state) noexcept {
+            tCurrent = state;
+        }
+
+        /**
+         * 在协程体之外恢复协程, 它挂起或结束之后还原调用者的当前区域
+         */
+        static void resume(std::coroutine_handle<> coroutine) {
+            FrameArenaState *saved = tCurrent;
+            coroutine.resume();
+            tCurrent = saved;
+        }
+
+    private:
+        struct Scope {
+            explicit Scope(FrameArenaState *state) noexcept : m_saved(tCurrent) {
+                tCurrent = state;
+            }
+
+            Scope(Scope &&) = delete;
+
+            ~Scope() {
+                tCurrent = m_saved;
+            }
+
+            FrameArenaState *m_saved;
+        };
+
+        FrameArenaState *m_state;
+
+        static inline thread_local FrameArenaState *tCurrent = nullptr;
+    };
+
+    /**
+     * promise_type 继承它之后, 协程帧在当前区域中分配, 没有区域时来自 FramePool
+     * (CO_ASYNC_FRAME_POOL 为 0 时来自全局 operator new, 区域不受影响)
+     * 帧前面有一个记录来源的头部, 释放时据此交还
+     */
+    struct ArenaFrame {
+        static void *operator new(std::size_t size) {
+            FrameArenaState *arena = FrameArena::current();
+            void *pointer = arena ? arena->allocate(size + sizeof(Header))
+                                  : fallbackAllocate(size + sizeof(Header));
+            auto *header = static_cast<Header *>(pointer);
+            header->m_arena = arena;
+            return header + 1;
+        }
+
+        static void operator delete(void *pointer, std::size_t size) noexcept {
+            auto *header = static_cast<Header *>(pointer) - 1;
+            if (header->m_arena) {
+                header->m_arena->deallocate(header, size + sizeof(Header));
+            } else {
+                fallbackDeallocate(header, size + sizeof(Header));
+            }
+        }
+
+    private:
+        struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) Header {
+            FrameArenaState *m_arena;
+        };
+
+        static void *fallbackAllocate(std::size_t size) {
+#if CO_ASYNC_FRAME_POOL
+            return FramePool::allocate(size);
+#else
+            return ::operator new(size);
+#endif
+        }
+
+        static void fallbackDeallocate(void *pointer, std::size_t size) noexcept {
+#if CO_ASYNC_FRAME_POOL
+            FramePool::deallocate(pointer, size);
+#else
+            ::operator delete(pointer, size);
+#endif
+        }
+    };
+
+    /**
+     * 记住协程所在区域的 promise 基类, 协程第一次运行时把它设为当前区域
+     * 之后的切换由挂起点负责: 会挂起的 awaiter 用 ArenaResume 在恢复时还原挂起前的区域,
+     * 循环和其他在协程体之外调用 resume() 的地方用 FrameArena::resume 在协程挂起后还原自己的区域
+     * 这样在 I/O 或定时器恢复之后创建的子协程仍然分配在同一个区域中,
+     * 没有使用 ArenaResume 的 awaiter 恢复后没有当前区域, 之后的帧退回到 FramePool
+     */
+    struct ArenaPromise : ArenaFrame {
+        /* 与 operator new 中使用的区域相同: promise 紧接着帧的分配构造 */
+        FrameArenaState *mArena = FrameArena::current();
+
+        /**
+         * 代替 std::suspend_always 作为 initial_suspend 的结果
+         */
+        struct InitialAwaiter {
+            bool await_ready() const noexcept {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<>) const noexcept {}
+
+            void await_resume() const noexcept {
+                FrameArena::setCurrent(mPromise.mArena);
+            }
+
+            ArenaPromise &mPromise;
+        };
+    };
+
+    /**
+     * 嵌入在会挂起的 awaiter 中: await_suspend 时记下当前区域, await_resume 时还原
+     * 构造时也记下一次, await_ready 直接返回 true 时还原的仍是协程自己的区域
+     */
+    struct ArenaResume {
+        void save() noexcept {
+            m_arena = FrameArena::current();
+        }
+
+        void restore() const noexcept {
+            FrameArena::setCurrent(m_arena);
+        }
+
+        FrameArenaState *m_arena = FrameArena::current();
+    };
+
+} // namespace co_async
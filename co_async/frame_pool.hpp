@@ -0,0 +1,161 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+/* 定义为 0 时协程帧直接使用全局 operator new, 便于对比或者配合内存检查工具 */
+#ifndef CO_ASYNC_FRAME_POOL
+#define CO_ASYNC_FRAME_POOL 1
+#endif
+
+namespace co_async {
+
+    struct FramePoolStats {
+        std::size_t allocations = 0;
+        std::size_t deallocations = 0;
+        /* 从空闲链表中取得、没有调用 malloc 的分配 */
+        std::size_t reused = 0;
+        /* 超过 kMaxPooledSize, 直接交给 malloc 的分配 */
+        std::size_t large = 0;
+
+        /* 分配中复用空闲块的比例 */
+        double reuseRate() const noexcept {
+            return allocations ? (double) reused / (double) allocations : 0.0;
+        }
+    };
+
+    /**
+     * FramePool 每个线程的缓存, 每一级一个空闲链表
+     */
+    struct FramePoolCache {
+        static constexpr std::size_t kGranularity = 64;
+        static constexpr std::size_t kMaxPooledSize = 2048;
+        static constexpr std::size_t kClasses = kMaxPooledSize / kGranularity;
+
+        struct FreeBlock {
+            FreeBlock *m_next;
+        };
+
+        FramePoolCache() noexcept = default;
+
+        FramePoolCache(FramePoolCache &&) = delete;
+
+        /* 线程退出后仍可能有全局对象析构时释放协程帧, 之后的释放直接 free */
+        ~FramePoolCache() {
+            release();
+            m_closed = true;
+        }
+
+        void release() noexcept {
+            for (std::size_t i = 0; i < kClasses; ++i) {
+                while (FreeBlock *block = m_free[i]) {
+                    m_free[i] = block->m_next;
+                    std::free(block);
+                }
+                m_count[i] = 0;
+            }
+        }
+
+        std::array<FreeBlock *, kClasses> m_free{};
+        std::array<std::uint32_t, kClasses> m_count{};
+        FramePoolStats m_stats;
+        bool m_closed = false;
+    };
+
+    /**
+     * 协程帧的线程局部分级内存池
+     * 按 64 字节分级, 每级一个单向空闲链表, 释放的帧挂回当前线程的链表中, 下次同级的分配直接取用;
+     * 在一个线程分配、另一个线程释放(例如被窃取的任务)也没有问题, 内存块只是换了一个线程缓存
+     * 超过 kMaxPooledSize 的帧以及每级缓存满了之后的释放直接交给 malloc/free
+     */
+    struct FramePool {
+        static constexpr std::size_t kGranularity = FramePoolCache::kGranularity;
+        static constexpr std::size_t kMaxPooledSize = FramePoolCache::kMaxPooledSize;
+        /* 每一级最多缓存的空闲块数, 避免突发之后长期占用内存 */
+        static constexpr std::size_t kMaxCached = 1024;
+
+        static void *allocate(std::size_t size) {
+            auto &cache = tCache;
+            ++cache.m_stats.allocations;
+            if (size > kMaxPooledSize) {
+                ++cache.m_stats.large;
+                return checkAlloc(std::malloc(size));
+            }
+            std::size_t index = sizeClass(size);
+            if (FreeBlock *block = cache.m_free[index]) {
+                cache.m_free[index] = block->m_next;
+                --cache.m_count[index];
+                ++cache.m_stats.reused;
+                return block;
+            }
+            return checkAlloc(std::malloc((index + 1) * kGranularity));
+        }
+
+        static void deallocate(void *pointer, std::size_t size) noexcept {
+            auto &cache = tCache;
+            ++cache.m_stats.deallocations;
+            if (size > kMaxPooledSize || cache.m_closed) {
+                std::free(pointer);
+                return;
+            }
+            std::size_t index = sizeClass(size);
+            if (cache.m_count[index] >= kMaxCached) {
+                std::free(pointer);
+                return;
+            }
+            auto *block = static_cast<FreeBlock *>(pointer);
+            block->m_next = cache.m_free[index];
+            cache.m_free[index] = block;
+            ++cache.m_count[index];
+        }
+
+        /**
+         * 当前线程的分配计数
+         */
+        static FramePoolStats const &stats() noexcept {
+            return tCache.m_stats;
+        }
+
+        /**
+         * 把当前线程缓存的空闲块全部还给 malloc
+         */
+        static void trim() noexcept {
+            tCache.release();
+        }
+
+    private:
+        static std::size_t sizeClass(std::size_t size) noexcept {
+            return size == 0 ? 0 : (size - 1) / kGranularity;
+        }
+
+        static void *checkAlloc(void *pointer) {
+            if (pointer == nullptr) [[unlikely]] {
+                throw std::bad_alloc();
+            }
+            return pointer;
+        }
+
+        using FreeBlock = FramePoolCache::FreeBlock;
+
+        static inline thread_local FramePoolCache tCache;
+    };
+
+    /**
+     * promise_type 继承它之后, 协程帧从 FramePool 分配
+     */
+    struct PooledFrame {
+#if CO_ASYNC_FRAME_POOL
+        static void *operator new(std::size_t size) {
+            return FramePool::allocate(size);
+        }
+
+        static void operator delete(void *pointer, std::size_t size) noexcept {
+            FramePool::deallocate(pointer, size);
+        }
+#endif
+    };
+
+} // namespace co_async
@@ -4,13 +4,14 @@
 #include <coroutine>
 #include <optional>
 #include <utility>
+#include "frame_pool.hpp"
 #include "uninitialized.hpp"
 #include "previous_awaiter.hpp"
 
 namespace co_async {
 
     template <class T>
-    struct GeneratorPromise {
+    struct GeneratorPromise : PooledFrame {
         auto initial_suspend() noexcept {
             return std::suspend_always();
         }
@@ -64,7 +65,7 @@ namespace co_async {
     };
 
     template <class T>
-    struct GeneratorPromise<T &> {
+    struct GeneratorPromise<T &> : PooledFrame {
         auto initial_suspend() noexcept {
             return std::suspend_always();
         }
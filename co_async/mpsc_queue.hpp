@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace co_async {
+
+    /**
+     * 无锁的多生产者单消费者队列, 主体是构造时分配好的环形数组, 投递时不分配内存
+     * 每个槽带一个序号: 生产者用 CAS 推进写位置占下一个槽, 写入之后发布序号, 消费者按序号判断槽是否写完
+     * 环满时退回到链栈, 只有这时才为每个元素分配节点; 链栈不空时所有生产者都压入链栈,
+     * 消费者只在环完全取空之后才取走链栈, 同一生产者的元素始终保持先进先出
+     *
+     * 计数在元素入队之前增加, 入队前计数为 0 的生产者负责唤醒消费者;
+     * 消费者取完之后计数仍不为 0 说明有生产者占了槽还没有写完, popAll 返回 true, 由消费者再唤醒自己一次
+     */
+    template <class T>
+    struct MpscQueue {
+        explicit MpscQueue(std::size_t capacity = 1024) {
+            std::size_t size = 1;
+            while (size < capacity) size <<= 1;
+            m_cells = std::make_unique<Cell[]>(size);
+            for (std::size_t i = 0; i < size; ++i) {
+                m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+            }
+            m_mask = size - 1;
+        }
+
+        MpscQueue(MpscQueue &&) = delete;
+
+        ~MpscQueue() {
+            Node *node = m_overflow.load(std::memory_order_acquire);
+            while (node) {
+                delete std::exchange(node, node->m_next);
+            }
+        }
+
+        /**
+         * 可以在任意线程调用
+         * @return 入队前队列为空时返回 true, 调用者据此决定是否需要唤醒消费者
+         */
+        bool push(T value) {
+            bool wasEmpty = m_size.fetch_add(1, std::memory_order_acq_rel) == 0;
+            if (m_overflow.load(std::memory_order_acquire) != nullptr || !tryPushRing(value)) {
+                pushOverflow(std::move(value));
+            }
+            return wasEmpty;
+        }
+
+        /**
+         * 只能在消费者线程调用, 按入队顺序把已经写完的元素交给 visitor
+         * @return 还有正在入队的元素时返回 true, 它们的生产者不会再唤醒消费者
+         */
+        template <class Visitor>
+        bool popAll(Visitor &&visitor) {
+            std::size_t popped = 0;
+            while (true) {
+                Cell &cell = m_cells[m_head & m_mask];
+                if (cell.m_sequence.load(std::memory_order_acquire) != m_head + 1) {
+                    break;
+                }
+                T value = std::move(cell.m_value);
+                cell.m_sequence.store(m_head + m_mask + 1, std::memory_order_release);
+                ++m_head;
+                ++popped;
+                visitor(std::move(value));
+            }
+            /* 环中还有占了槽没写完的元素时不能取链栈, 它们可能比链栈中的元素更早 */
+            if (m_tail.load(std::memory_order_acquire) == m_head) {
+                Node *node = m_overflow.exchange(nullptr, std::memory_order_acquire);
+                Node *reversed = nullptr;
+                while (node) {
+                    Node *next = node->m_next;
+                    node->m_next = reversed;
+                    reversed = node;
+                    node = next;
+                }
+                while (reversed) {
+                    Node *next = reversed->m_next;
+                    visitor(std::move(reversed->m_value));
+                    delete reversed;
+                    reversed = next;
+                    ++popped;
+                }
+            }
+            return m_size.fetch_sub(popped, std::memory_order_acq_rel) != popped;
+        }
+
+        bool empty() const noexcept {
+            return m_size.load(std::memory_order_relaxed) == 0;
+        }
+
+    private:
+        struct Cell {
+            std::atomic<std::size_t> m_sequence;
+            T m_value;
+        };
+
+        struct Node {
+            T m_value;
+            Node *m_next;
+        };
+
+        /* 环满时返回 false, value 保持不变 */
+        bool tryPushRing(T &value) {
+            std::size_t pos = m_tail.load(std::memory_order_relaxed);
+            while (true) {
+                Cell &cell = m_cells[pos & m_mask];
+                std::size_t sequence = cell.m_sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+                if (diff == 0) {
+                    if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        cell.m_value = std::move(value);
+                        cell.m_sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = m_tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void pushOverflow(T value) {
+            auto *node = new Node{std::move(value), m_overflow.load(std::memory_order_relaxed)};
+            while (!m_overflow.compare_exchange_weak(node->m_next, node,
+                                                     std::memory_order_release,
+                                                     std::memory_order_relaxed)) {
+            }
+        }
+
+        std::unique_ptr<Cell[]> m_cells;
+        std::size_t m_mask;
+        /* 已经入队和正在入队的元素数 */
+        alignas(64) std::atomic<std::size_t> m_size{0};
+        /* 生产者共享的写位置 */
+        alignas(64) std::atomic<std::size_t> m_tail{0};
+        std::atomic<Node *> m_overflow{nullptr};
+        /* 只有消费者访问的读位置 */
+        alignas(64) std::size_t m_head = 0;
+    };
+
+} // namespace co_async
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+namespace co_async {
+
+    /**
+     * 侵入式配对堆, 元素继承 PairingHeap::Node, 不需要任何额外的内存分配
+     * 插入 O(1), 删除最小元素和删除任意元素均摊 O(log n);
+     * 插入的节点直接挂在根下, 适合大量插入、很多在到期前就被删除的超时
+     * 和 RbNode 一样, 节点析构时自动从堆中摘除
+     */
+    template <class Value, class Compare = std::less<Value>>
+    struct PairingHeap {
+        struct Node {
+            Node() noexcept = default;
+
+            Node(Node &&) = delete;
+
+            ~Node() noexcept {
+                if (m_heap) {
+                    m_heap->erase(static_cast<Value &>(*this));
+                }
+            }
+
+            friend struct PairingHeap;
+
+        private:
+            Node *m_child = nullptr;
+            Node *m_next = nullptr;
+            /* 最左边的孩子指向父节点, 其余指向左边的兄弟 */
+            Node *m_prev = nullptr;
+            PairingHeap *m_heap = nullptr;
+        };
+
+        PairingHeap() = default;
+
+        explicit PairingHeap(Compare comp) noexcept(noexcept(Compare(comp))) : m_comp(comp) {}
+
+        PairingHeap(PairingHeap &&) = delete;
+
+        void insert(Value &value) noexcept {
+            Node &node = value;
+            node.m_child = node.m_next = node.m_prev = nullptr;
+            node.m_heap = this;
+            m_root = meld(m_root, &node);
+        }
+
+        void erase(Value &value) noexcept {
+            Node &node = value;
+            node.m_heap = nullptr;
+            if (&node == m_root) {
+                m_root = mergePairs(node.m_child);
+            } else {
+                /* 从兄弟链表中摘下以 node 为根的子树, 再把它的孩子合并回来 */
+                if (node.m_prev->m_child == &node) {
+                    node.m_prev->m_child = node.m_next;
+                } else {
+                    node.m_prev->m_next = node.m_next;
+                }
+                if (node.m_next) {
+                    node.m_next->m_prev = node.m_prev;
+                }
+                m_root = meld(m_root, mergePairs(node.m_child));
+            }
+            node.m_child = node.m_next = node.m_prev = nullptr;
+        }
+
+        bool empty() const noexcept {
+            return m_root == nullptr;
+        }
+
+        Value &front() const noexcept {
+            return static_cast<Value &>(*m_root);
+        }
+
+        void popFront() noexcept {
+            erase(front());
+        }
+
+    private:
+        bool less(Node *left, Node *right) const noexcept {
+            return m_comp(static_cast<Value &>(*left), static_cast<Value &>(*right));
+        }
+
+        /**
+         * 合并两个堆, 较大的根成为较小的根的最左孩子
+         */
+        Node *meld(Node *first, Node *second) noexcept {
+            if (first == nullptr) return second;
+            if (second == nullptr) return first;
+            if (less(second, first)) {
+                std::swap(first, second);
+            }
+            second->m_prev = first;
+            second->m_next = first->m_child;
+            if (first->m_child) {
+                first->m_child->m_prev = second;
+            }
+            first->m_child = second;
+            first->m_next = first->m_prev = nullptr;
+            return first;
+        }
+
+        /**
+         * 两趟合并兄弟链表: 先从左到右两两合并, 再从右到左依次合并
+         * 第一趟的结果通过 m_prev 串成反向链表, 不需要递归或额外的栈
+         */
+        Node *mergePairs(Node *first) noexcept {
+            Node *paired = nullptr;
+            while (first) {
+                Node *second = first->m_next;
+                if (second == nullptr) {
+                    first->m_prev = paired;
+                    paired = first;
+                    break;
+                }
+                Node *rest = second->m_next;
+                Node *merged = meld(first, second);
+                merged->m_prev = paired;
+                paired = merged;
+                first = rest;
+            }
+            Node *result = nullptr;
+            while (paired) {
+                Node *previous = paired->m_prev;
+                result = meld(paired, result);
+                paired = previous;
+            }
+            if (result) {
+                result->m_prev = result->m_next = nullptr;
+            }
+            return result;
+        }
+
+        Node *m_root = nullptr;
+        Compare m_comp;
+    };
+
+} // namespace co_async
@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <functional>
+#include <initializer_list>
 #include <utility>
 
 namespace co_async {
@@ -40,6 +41,9 @@ namespace co_async {
 
     private:
         RbNode *root;
+        /* 缓存的最小、最大节点, front()/back() 不需要从根向下查找 */
+        RbNode *leftmost;
+        RbNode *rightmost;
         Compare comp;
 
         bool compare(RbNode *left, RbNode *right) const noexcept {
@@ -141,16 +145,28 @@ namespace co_async {
 
             RbNode *parent = nullptr;
             RbNode *current = root;
+            /* 一路向左(向右)走到底的节点成为新的最小(最大)节点 */
+            bool isLeftmost = true;
+            bool isRightmost = true;
 
             while (current != nullptr) {
                 parent = current;
                 if (compare(node, current)) {
                     current = current->left;
+                    isRightmost = false;
                 } else {
                     current = current->right;
+                    isLeftmost = false;
                 }
             }
 
+            if (isLeftmost) {
+                leftmost = node;
+            }
+            if (isRightmost) {
+                rightmost = node;
+            }
+
             node->parent = parent;
             if (parent == nullptr) {
                 root = node;
@@ -219,79 +235,195 @@ namespace co_async {
         /*     } */
         /* } */
 
+        /**
+         * 用 v 为根的子树替换 u 为根的子树
+         */
+        void transplant(RbNode *u, RbNode *v) noexcept {
+            if (u->parent == nullptr) {
+                root = v;
+            } else if (u == u->parent->left) {
+                u->parent->left = v;
+            } else {
+                u->parent->right = v;
+            }
+            if (v != nullptr) {
+                v->parent = u->parent;
+            }
+        }
+
+        /**
+         * 删除任意节点, 按《算法导论》的 RB-DELETE, 空叶子用 nullptr 表示,
+         * 所以需要单独记录被移动节点 node 的父节点
+         */
         void doErase(RbNode *current) noexcept {
             current->tree = nullptr;
+            if (current == leftmost) {
+                leftmost = successor(current);
+            }
+            if (current == rightmost) {
+                rightmost = predecessor(current);
+            }
 
             RbNode *node = nullptr;
-            RbNode *child = nullptr;
-            RbColor color = RED;
-
-            if (current->left != nullptr && current->right != nullptr) {
-                RbNode *replace = current;
-                replace = replace->right;
+            RbNode *parent = nullptr;
+            RbColor color = current->color;
+
+            if (current->left == nullptr) {
+                node = current->right;
+                parent = current->parent;
+                transplant(current, current->right);
+            } else if (current->right == nullptr) {
+                node = current->left;
+                parent = current->parent;
+                transplant(current, current->left);
+            } else {
+                RbNode *replace = current->right;
                 while (replace->left != nullptr) {
                     replace = replace->left;
                 }
-
-                if (current != replace->parent) {
-                    current->parent->left = replace->right;
-                    replace->right = current->right;
-                    current->right->parent = replace;
+                color = replace->color;
+                node = replace->right;
+                if (replace->parent == current) {
+                    parent = replace;
                 } else {
-                    replace->parent = current;
-                }
-
-                if (current == root) {
-                    root = replace;
-                } else if (current->parent->left == current) {
-                    current->parent->left = replace;
-                } else {
-                    current->parent->right = replace;
+                    parent = replace->parent;
+                    transplant(replace, replace->right);
+                    replace->right = current->right;
+                    replace->right->parent = replace;
                 }
-
+                transplant(current, replace);
                 replace->left = current->left;
-                current->left->parent = replace;
-
-                node = replace;
-                color = node->color;
-                child = node->right;
-            } else {
-                node = current;
-                color = node->color;
-                child = (node->left != nullptr) ? node->left : node->right;
+                replace->left->parent = replace;
+                replace->color = current->color;
             }
 
-            if (child != nullptr) {
-                child->parent = node->parent;
+            if (color == BLACK) {
+                fixErase(node, parent);
             }
+        }
 
-            if (node == root) {
-                root = child;
-            } else if (node->parent->left == node) {
-                node->parent->left = child;
-            } else {
-                node->parent->right = child;
+        static bool isBlack(RbNode *node) noexcept {
+            return node == nullptr || node->color == BLACK;
+        }
+
+        /**
+         * 删除黑色节点后 node 所在的路径少了一个黑色节点, 通过旋转和重新着色恢复
+         */
+        void fixErase(RbNode *node, RbNode *parent) noexcept {
+            while (node != root && isBlack(node)) {
+                if (node == parent->left) {
+                    RbNode *sibling = parent->right;
+                    if (sibling->color == RED) {
+                        sibling->color = BLACK;
+                        parent->color = RED;
+                        rotateLeft(parent);
+                        sibling = parent->right;
+                    }
+                    if (isBlack(sibling->left) && isBlack(sibling->right)) {
+                        sibling->color = RED;
+                        node = parent;
+                        parent = node->parent;
+                    } else {
+                        if (isBlack(sibling->right)) {
+                            sibling->left->color = BLACK;
+                            sibling->color = RED;
+                            rotateRight(sibling);
+                            sibling = parent->right;
+                        }
+                        sibling->color = parent->color;
+                        parent->color = BLACK;
+                        sibling->right->color = BLACK;
+                        rotateLeft(parent);
+                        node = root;
+                    }
+                } else {
+                    RbNode *sibling = parent->left;
+                    if (sibling->color == RED) {
+                        sibling->color = BLACK;
+                        parent->color = RED;
+                        rotateRight(parent);
+                        sibling = parent->left;
+                    }
+                    if (isBlack(sibling->left) && isBlack(sibling->right)) {
+                        sibling->color = RED;
+                        node = parent;
+                        parent = node->parent;
+                    } else {
+                        if (isBlack(sibling->left)) {
+                            sibling->right->color = BLACK;
+                            sibling->color = RED;
+                            rotateLeft(sibling);
+                            sibling = parent->left;
+                        }
+                        sibling->color = parent->color;
+                        parent->color = BLACK;
+                        sibling->left->color = BLACK;
+                        rotateRight(parent);
+                        node = root;
+                    }
+                }
             }
+            if (node != nullptr) {
+                node->color = BLACK;
+            }
+        }
 
-            if (color == BLACK && root) {
-                fixViolation(child ? child : node->parent);
+        /**
+         * 中序遍历的下一个节点, 均摊 O(1), 不存在时返回 nullptr
+         */
+        static RbNode *successor(RbNode *node) noexcept {
+            if (node->right != nullptr) {
+                node = node->right;
+                while (node->left != nullptr) {
+                    node = node->left;
+                }
+                return node;
+            }
+            RbNode *parent = node->parent;
+            while (parent != nullptr && node == parent->right) {
+                node = parent;
+                parent = parent->parent;
             }
+            return parent;
         }
 
-        RbNode *getFront() const noexcept {
-            RbNode *current = root;
-            while (current->left != nullptr) {
-                current = current->left;
+        static RbNode *predecessor(RbNode *node) noexcept {
+            if (node->left != nullptr) {
+                node = node->left;
+                while (node->right != nullptr) {
+                    node = node->right;
+                }
+                return node;
             }
-            return current;
+            RbNode *parent = node->parent;
+            while (parent != nullptr && node == parent->left) {
+                node = parent;
+                parent = parent->parent;
+            }
+            return parent;
         }
 
-        RbNode *getBack() const noexcept {
-            RbNode *current = root;
-            while (current->right != nullptr) {
-                current = current->right;
+        /**
+         * 返回子树的黑高, 子树中有节点违反红黑树性质或者父子指针不一致时返回 -1
+         */
+        int checkSubtree(RbNode *node) const noexcept {
+            if (node == nullptr) {
+                return 1;
+            }
+            if (node->tree != this) {
+                return -1;
             }
-            return current;
+            for (RbNode *child : {node->left, node->right}) {
+                if (child != nullptr && (child->parent != node || (node->color == RED && child->color == RED))) {
+                    return -1;
+                }
+            }
+            int leftHeight = checkSubtree(node->left);
+            int rightHeight = checkSubtree(node->right);
+            if (leftHeight == -1 || leftHeight != rightHeight) {
+                return -1;
+            }
+            return leftHeight + (node->color == BLACK ? 1 : 0);
         }
 
         template <class Visitor>
@@ -300,16 +432,20 @@ namespace co_async {
                 return;
             }
 
-            traversalInorder(node->left, visitor);
+            doTraversalInorder(node->left, visitor);
             visitor(node);
             doTraversalInorder(node->right, visitor);
         }
 
     public:
-        RbTree() noexcept : root(nullptr) {}
+        RbTree() noexcept : root(nullptr),
+        leftmost(nullptr),
+        rightmost(nullptr) {}
 
         explicit RbTree(Compare comp) noexcept(noexcept(Compare(comp)))
         : root(nullptr),
+        leftmost(nullptr),
+        rightmost(nullptr),
         comp(comp) {}
 
         RbTree(RbTree &&) = delete;
@@ -329,17 +465,60 @@ namespace co_async {
         }
 
         Value &front() const noexcept {
-            return static_cast<Value &>(*getFront());
+            return static_cast<Value &>(*leftmost);
         }
 
         Value &back() const noexcept {
-            return static_cast<Value &>(*getBack());
+            return static_cast<Value &>(*rightmost);
+        }
+
+        /**
+         * 按顺序的下一个元素, value 是最后一个时返回 nullptr
+         * 从某个元素开始向后扫描时不需要每次从根重新查找
+         */
+        Value *next(Value &value) const noexcept {
+            RbNode *node = successor(&static_cast<RbNode &>(value));
+            return node ? &static_cast<Value &>(*node) : nullptr;
+        }
+
+        Value *prev(Value &value) const noexcept {
+            RbNode *node = predecessor(&static_cast<RbNode &>(value));
+            return node ? &static_cast<Value &>(*node) : nullptr;
         }
 
         template <class Visitor>
         void traversalInorder(Visitor &&visitor) {
             doTraversalInorder(root, std::forward<Visitor>(visitor));
         }
+
+        /**
+         * 检查红黑树的性质、中序有序以及缓存的最小、最大节点, O(n), 用于测试
+         */
+        bool checkInvariants() const noexcept {
+            if (root == nullptr) {
+                return leftmost == nullptr && rightmost == nullptr;
+            }
+            if (root->color != BLACK || root->parent != nullptr || checkSubtree(root) == -1) {
+                return false;
+            }
+            RbNode *first = root;
+            while (first->left != nullptr) {
+                first = first->left;
+            }
+            RbNode *last = root;
+            while (last->right != nullptr) {
+                last = last->right;
+            }
+            if (first != leftmost || last != rightmost) {
+                return false;
+            }
+            for (RbNode *node = first, *next; (next = successor(node)) != nullptr; node = next) {
+                if (compare(next, node)) {
+                    return false;
+                }
+            }
+            return true;
+        }
     };
 
 } // namespace co_async
\ No newline at end of file
@@ -2,11 +2,13 @@
 
 #include <exception>
 #include <coroutine>
+#include "cancel.hpp"
+#include "frame_arena.hpp"
 #include "task.hpp"
 
 namespace co_async {
 
-    struct ReturnPreviousPromise {
+    struct ReturnPreviousPromise : ArenaFrame, CancellablePromise {
         auto initial_suspend() noexcept {
             return std::suspend_always();
         }
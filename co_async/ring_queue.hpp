@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace co_async {
+
+    /**
+     * 容量为 2 的幂、满时自动翻倍的环形先进先出队列, 单线程使用
+     */
+    template <class T>
+    struct RingQueue {
+        explicit RingQueue(std::size_t capacity = 64) {
+            std::size_t size = 1;
+            while (size < capacity) size <<= 1;
+            m_slots = std::make_unique<T[]>(size);
+            m_mask = size - 1;
+        }
+
+        RingQueue(RingQueue &&) = delete;
+
+        void push(T value) {
+            if (m_tail - m_head > m_mask) {
+                grow();
+            }
+            m_slots[m_tail++ & m_mask] = std::move(value);
+        }
+
+        T pop() {
+            return std::move(m_slots[m_head++ & m_mask]);
+        }
+
+        bool empty() const noexcept {
+            return m_head == m_tail;
+        }
+
+        std::size_t size() const noexcept {
+            return m_tail - m_head;
+        }
+
+    private:
+        void grow() {
+            std::size_t capacity = (m_mask + 1) * 2;
+            auto slots = std::make_unique<T[]>(capacity);
+            std::size_t count = size();
+            for (std::size_t i = 0; i < count; ++i) {
+                slots[i] = std::move(m_slots[(m_head + i) & m_mask]);
+            }
+            m_slots = std::move(slots);
+            m_mask = capacity - 1;
+            m_head = 0;
+            m_tail = count;
+        }
+
+        std::unique_ptr<T[]> m_slots;
+        std::size_t m_mask;
+        /* 单调递增的读写位置, 取模后才是下标 */
+        std::size_t m_head = 0;
+        std::size_t m_tail = 0;
+    };
+
+} // namespace co_async
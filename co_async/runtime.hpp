@@ -0,0 +1,336 @@
+#pragma once
+
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "task.hpp"
+#include "async_loop.hpp"
+#include "work_stealing_deque.hpp"
+
+namespace co_async {
+
+    /**
+     * 结束后自行销毁的协程, 由运行时投递到某个循环上执行
+     */
+    struct DetachedPromise : PooledFrame {
+        auto initial_suspend() noexcept {
+            return std::suspend_always();
+        }
+
+        auto final_suspend() noexcept {
+            return std::suspend_never();
+        }
+
+        /* 异常在协程体内已经捕获 */
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+
+        void return_void() noexcept {}
+
+        auto get_return_object() {
+            return std::coroutine_handle<DetachedPromise>::from_promise(*this);
+        }
+
+        DetachedPromise &operator=(DetachedPromise &&) = delete;
+    };
+
+    struct DetachedTask {
+        using promise_type = DetachedPromise;
+
+        DetachedTask(std::coroutine_handle<promise_type> coroutine) noexcept : mCoroutine(coroutine) {}
+
+        std::coroutine_handle<promise_type> mCoroutine;
+    };
+
+    /**
+     * 每个核心一个线程的多循环运行时
+     * 每个线程拥有独立的 Loop (各自的 EpollLoop 和 TimerLoop), 线程之间只通过 Loop::post 通信
+     * 任务在创建时就绑定了循环, 所以 spawn 接受一个以 Loop& 为参数、返回 Task 的工厂函数,
+     * 工厂函数总是在最终运行它的循环自己的线程里调用
+     * spawn 可以在任务里或者其他线程中调用(此时必须还有任务没有结束), 也可以在 run 之前
+     * 由调用 run 的线程调用
+     *
+     * 开启工作窃取后, 不指定循环的 spawn 在任务里调用时把任务压入当前线程的双端队列,
+     * 空闲的线程会从忙碌的线程那里窃取. 只有还没启动的任务可以被窃取,
+     * 启动之后它等待的 fd 和定时器都注册在所在的循环上, 不能再迁移
+     */
+    template <class Loop = AsyncLoop>
+    struct BasicRuntime {
+        /**
+         * @param threads 线程(循环)数, 默认为 CPU 核数
+         * @param pin 是否把第 i 个线程绑定到第 i 个核心
+         */
+        explicit BasicRuntime(std::size_t threads = std::thread::hardware_concurrency(),
+                              bool pin = true)
+                : m_workers(std::max<std::size_t>(threads, 1)), m_pin(pin) {}
+
+        BasicRuntime &operator=(BasicRuntime &&) = delete;
+
+        std::size_t size() const noexcept {
+            return m_workers.size();
+        }
+
+        Loop &loop(std::size_t index) noexcept {
+            return m_workers[index].m_loop;
+        }
+
+        /**
+         * 在指定的循环上创建并运行任务
+         * 调用者就在目标循环的线程里时立即启动, 否则投递给目标循环
+         */
+        template <class F>
+        requires std::invocable<F, Loop &>
+        void spawn(std::size_t index, F &&factory) {
+            auto &worker = m_workers[index % size()];
+            auto coroutine = makeEntry(std::forward<F>(factory));
+            if (tCurrentWorker == &worker) {
+                FrameArena::resume(coroutine);
+            } else {
+                worker.m_loop.post(coroutine);
+            }
+        }
+
+        /**
+         * 轮流把任务分配给各个循环, 开启工作窃取时则交给窃取调度
+         */
+        template <class F>
+        requires std::invocable<F, Loop &>
+        void spawn(F &&factory) {
+            if (m_stealing) {
+                if (auto *worker = currentWorker()) {
+                    bool wasEmpty = worker->m_deque.empty();
+                    worker->m_deque.push(makeEntry(std::forward<F>(factory)));
+                    /* 任务多半是在循环的这一轮中 spawn 的, 排一个空协程让这一轮不阻塞, 回到 runStealable */
+                    if (wasEmpty) {
+                        worker->m_loop.schedule(std::noop_coroutine());
+                    }
+                    wakeIdle(*worker);
+                    return;
+                }
+                if (!m_running.load(std::memory_order_relaxed)) {
+                    auto &worker = m_workers[m_next.fetch_add(1, std::memory_order_relaxed) % size()];
+                    worker.m_deque.push(makeEntry(std::forward<F>(factory)));
+                    return;
+                }
+            }
+            spawn(m_next.fetch_add(1, std::memory_order_relaxed), std::forward<F>(factory));
+        }
+
+        /**
+         * 开启或关闭工作窃取, 只能在 run 之前调用
+         */
+        void setStealing(bool stealing) noexcept {
+            m_stealing = stealing;
+        }
+
+        /**
+         * 各线程成功窃取的任务总数, 在 run 返回之后读取
+         */
+        std::size_t stolen() const noexcept {
+            std::size_t count = 0;
+            for (auto &worker: m_workers) {
+                count += worker.m_stolen;
+            }
+            return count;
+        }
+
+        /**
+         * 启动所有线程, 直到所有任务结束、每个循环都没有任务为止
+         * 之后重新抛出最先发生的任务异常
+         */
+        void run() {
+            if (m_live.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+            /* 投递不会让循环保持运行, 任务全部结束之前由运行时持有每个循环 */
+            for (auto &worker: m_workers) {
+                worker.m_loop.retain();
+            }
+            m_running.store(true, std::memory_order_relaxed);
+            for (std::size_t i = 0; i < size(); ++i) {
+                m_workers[i].m_thread = std::thread([this, i] { work(i); });
+            }
+            for (auto &worker: m_workers) {
+                worker.m_thread.join();
+            }
+            m_running.store(false, std::memory_order_relaxed);
+            if (auto exception = std::exchange(m_exception, nullptr)) {
+                std::rethrow_exception(exception);
+            }
+        }
+
+    private:
+        struct Worker {
+            Loop m_loop;
+            /* 还没有启动、可以被窃取的任务 */
+            WorkStealingDeque<std::coroutine_handle<>> m_deque;
+            /* 即将阻塞在 m_loop.run 中, 有新任务可窃取时需要投递一个空协程唤醒 */
+            std::atomic<bool> m_sleeping{false};
+            std::size_t m_stolen = 0;
+            std::thread m_thread;
+        };
+
+        /* 每次最多连续运行的可窃取任务数, 避免饿死 I/O 和定时器 */
+        static constexpr std::size_t kStealBudget = 64;
+
+        template <class F>
+        std::coroutine_handle<> makeEntry(F &&factory) {
+            m_live.fetch_add(1, std::memory_order_relaxed);
+            return entry<std::decay_t<F>>(this, std::forward<F>(factory)).mCoroutine;
+        }
+
+        /**
+         * 所在的循环在第一次恢复时才确定, 被窃取的任务会运行在窃取者的循环上
+         */
+        template <class F>
+        static DetachedTask entry(BasicRuntime *self, F factory) {
+            try {
+                co_await factory(tCurrentWorker->m_loop);
+            } catch (...) {
+                std::lock_guard lock(self->m_mutex);
+                if (!self->m_exception) {
+                    self->m_exception = std::current_exception();
+                }
+            }
+            self->finish();
+        }
+
+        static DetachedTask releaseLoop(Loop &loop) {
+            loop.release();
+            co_return;
+        }
+
+        /**
+         * 最后一个任务结束时让每个循环在自己的线程里释放运行时的持有
+         */
+        void finish() {
+            if (m_live.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                for (auto &worker: m_workers) {
+                    worker.m_loop.post(releaseLoop(worker.m_loop).mCoroutine);
+                }
+            }
+        }
+
+        Worker *currentWorker() const noexcept {
+            auto *worker = tCurrentWorker;
+            if (worker >= m_workers.data() && worker < m_workers.data() + size()) {
+                return worker;
+            }
+            return nullptr;
+        }
+
+        void work(std::size_t index) {
+            if (m_pin) {
+                pinToCore(index);
+            }
+            auto &worker = m_workers[index];
+            tCurrentWorker = &worker;
+            if (m_stealing) {
+                while (true) {
+                    if (runStealable(worker)) {
+                        /* 预算用完, 仍然要处理一轮 I/O 和定时器, 但不能阻塞 */
+                        worker.m_loop.post(std::noop_coroutine());
+                    } else {
+                        worker.m_sleeping.store(true, std::memory_order_relaxed);
+                        /* 与 wakeIdle 配对: 要么这里看到新任务, 要么对方看到 m_sleeping */
+                        std::atomic_thread_fence(std::memory_order_seq_cst);
+                        if (hasStealable()) {
+                            worker.m_sleeping.store(false, std::memory_order_relaxed);
+                            worker.m_loop.post(std::noop_coroutine());
+                        }
+                    }
+                    bool more = worker.m_loop.run();
+                    worker.m_sleeping.store(false, std::memory_order_relaxed);
+                    if (!more) break;
+                }
+            } else {
+                while (worker.m_loop.run());
+            }
+            tCurrentWorker = nullptr;
+        }
+
+        /**
+         * 先运行自己队列中的任务, 没有了再依次从其他线程窃取
+         * @return 预算用完时返回 true, 表示可能还有任务
+         */
+        bool runStealable(Worker &worker) {
+            for (std::size_t budget = kStealBudget; budget != 0; --budget) {
+                auto coroutine = worker.m_deque.pop();
+                if (!coroutine) {
+                    coroutine = stealFrom(worker);
+                    if (!coroutine) {
+                        return false;
+                    }
+                    ++worker.m_stolen;
+                }
+                FrameArena::resume(*coroutine);
+            }
+            return true;
+        }
+
+        std::optional<std::coroutine_handle<>> stealFrom(Worker &thief) {
+            std::size_t index = &thief - m_workers.data();
+            for (std::size_t i = 1; i < size(); ++i) {
+                if (auto coroutine = m_workers[(index + i) % size()].m_deque.steal()) {
+                    return coroutine;
+                }
+            }
+            return std::nullopt;
+        }
+
+        bool hasStealable() const noexcept {
+            for (auto &worker: m_workers) {
+                if (!worker.m_deque.empty()) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * 唤醒一个阻塞中的线程来窃取刚压入的任务
+         */
+        void wakeIdle(Worker &self) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            for (auto &worker: m_workers) {
+                if (&worker != &self && worker.m_sleeping.load(std::memory_order_relaxed)
+                    && worker.m_sleeping.exchange(false, std::memory_order_acq_rel)) {
+                    worker.m_loop.post(std::noop_coroutine());
+                    return;
+                }
+            }
+        }
+
+        static void pinToCore(std::size_t index) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(index % std::max(std::thread::hardware_concurrency(), 1u), &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        }
+
+        static inline thread_local Worker *tCurrentWorker = nullptr;
+
+        std::vector<Worker> m_workers;
+        std::atomic<std::size_t> m_next{0};
+        /* 已经 spawn 但还没有结束的任务数 */
+        std::atomic<std::size_t> m_live{0};
+        std::atomic<bool> m_running{false};
+        std::mutex m_mutex;
+        std::exception_ptr m_exception;
+        bool m_pin;
+        bool m_stealing = false;
+    };
+
+    using Runtime = BasicRuntime<>;
+
+} // namespace co_async
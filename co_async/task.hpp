@@ -1,7 +1,10 @@
 #pragma once
 #include <coroutine>
 #include <exception>
+#include <type_traits>
 #include <utility>
+#include "cancel.hpp"
+#include "frame_arena.hpp"
 #include "previous_awaiter.hpp"
 #include "uninitialized.hpp"
 #include "debug.hpp"
@@ -9,13 +12,13 @@
 namespace co_async {
 
 template<class T>
-struct Promise {
+struct Promise : ArenaPromise, CancellablePromise {
     /**
      * 表示协程在开始时会被挂起, 直到外部代码显式恢复它
      * @return
      */
     auto initial_suspend() noexcept {
-        return std::suspend_always();
+        return InitialAwaiter{*this};
     }
     /**
      * 允许协程结束后恢复前一个协程
@@ -60,12 +63,12 @@ struct Promise {
 };
 
 template <>
-struct Promise<void> {
-    auto initial_suspend() const noexcept {
-        return std::suspend_always();
+struct Promise<void> : ArenaPromise, CancellablePromise {
+    auto initial_suspend() noexcept {
+        return InitialAwaiter{*this};
     }
 
-    auto final_suspend() const noexcept {
+    auto final_suspend() noexcept {
         return Previous_awaiter(mPrevious);
     }
 
@@ -116,20 +119,30 @@ struct [[nodiscard]] Task {
         /**
          * 将当前协程句柄保存到 promise.mPrevious
          * 并返回 mCoroutine, 用于控制协程的恢复。
+         * 子协程没有关联 CancelToken 时继承当前协程的
          * @param routine
          * @return
          */
+        template <class Caller>
         std::coroutine_handle<promise_type>
-        await_suspend(std::coroutine_handle<> routine) const noexcept {
+        await_suspend(std::coroutine_handle<Caller> routine) noexcept {
+            mArena.save();
             promise_type &promise = mCoroutine.promise();
             promise.mPrevious = routine;
+            if constexpr (std::is_base_of_v<CancellablePromise, promise_type>) {
+                if (!promise.mCancelToken.cancellable()) {
+                    promise.mCancelToken = cancelTokenOf(routine);
+                }
+            }
             return mCoroutine;
         }
         T await_resume() const {
+            mArena.restore();
             return mCoroutine.promise().result();
         }
 
         std::coroutine_handle<promise_type> mCoroutine;
+        ArenaResume mArena;
     };
 
     /**
@@ -156,7 +169,7 @@ struct [[nodiscard]] Task {
 template<class Loop, class T, class P>
 T run_task(Loop &loop, Task<T, P> const& t) {
     auto a = t.operator co_await(); // 获取Awaiter对象a
-    a.await_suspend(std::noop_coroutine()).resume(); // 将当前协程挂起并准备恢复
+    FrameArena::resume(a.await_suspend(std::noop_coroutine())); // 将当前协程挂起并准备恢复
     while(loop.run()); // 运行直到没有更多的任务需要处理
     return a.await_resume(); // 获取协程的返回值并返回
 }
@@ -165,17 +178,26 @@ T run_task(Loop &loop, Task<T, P> const& t) {
 template<class Loop>
 void run_task(Loop &loop, Task<> const& t) {
     auto a = t.operator co_await();
-    a.await_suspend(std::noop_coroutine()).resume();
+    FrameArena::resume(a.await_suspend(std::noop_coroutine()));
     while (loop.run());
     a.await_resume(); // 对于 Task<>，没有返回值
 }
 
+/**
+ * 让任务关联一个 CancelToken, 它 co_await 的所有子任务都会继承
+ */
+template <class T, class P>
+Task<T, P> with_cancel(Task<T, P> task, CancelToken token) noexcept {
+    task.mCoroutine.promise().mCancelToken = token;
+    return task;
+}
+
 /**
  * 用在并发情况下不需要等待结果时
  */
 template <class T, class P>
 void spawn_task(Task<T, P> const &t) {
     auto a = t.operator co_await();
-    a.await_suspend(std::noop_coroutine()).resume();
+    FrameArena::resume(a.await_suspend(std::noop_coroutine()));
 }
 }
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <utility>
+#include "cancel.hpp"
+#include "frame_arena.hpp"
+#include "task.hpp"
+
+namespace co_async {
+
+    struct TaskGroup;
+
+    /**
+     * TaskGroup 中每个任务的外层协程, 持有被启动的 Task
+     * promise 自身就是组内双向链表的节点, 启动任务除了这一个协程帧之外不需要其他分配
+     * 结束时把自己从组中摘除并销毁, 连同其中的 Task 一起释放
+     */
+    struct TaskGroupPromise : ArenaFrame, CancellablePromise {
+        struct FinalAwaiter {
+            bool await_ready() const noexcept {
+                return false;
+            }
+
+            inline std::coroutine_handle<>
+            await_suspend(std::coroutine_handle<TaskGroupPromise> coroutine) const noexcept;
+
+            void await_resume() const noexcept {}
+        };
+
+        auto initial_suspend() noexcept {
+            return std::suspend_always();
+        }
+
+        auto final_suspend() noexcept {
+            return FinalAwaiter();
+        }
+
+        void unhandled_exception() {
+            throw;
+        }
+
+        void return_void() noexcept {}
+
+        auto get_return_object() {
+            return std::coroutine_handle<TaskGroupPromise>::from_promise(*this);
+        }
+
+        TaskGroup *mGroup = nullptr;
+        TaskGroupPromise *mPrev = nullptr;
+        TaskGroupPromise *mNext = nullptr;
+
+        TaskGroupPromise &operator=(TaskGroupPromise &&) = delete;
+    };
+
+    struct TaskGroupTask {
+        using promise_type = TaskGroupPromise;
+
+        TaskGroupTask(std::coroutine_handle<promise_type> coroutine) noexcept
+                : mCoroutine(coroutine) {}
+
+        std::coroutine_handle<promise_type> mCoroutine;
+    };
+
+    /**
+     * 结构化并发的任务组, 拥有通过 spawn 启动的所有任务
+     * 任务结束时立即释放协程帧; 第一个异常被保存下来, 同时取消组内其他任务;
+     * co_await 任务组等待所有任务结束, 并重新抛出第一个异常
+     * 任务组析构时销毁还没有结束的任务
+     *
+     *     TaskGroup group;
+     *     while (true) {
+     *         auto file = co_await accept(loop, listener);
+     *         group.spawn(handleConnection(loop, std::move(file)));
+     *     }
+     *     co_await group;
+     *
+     * 任务没有自己的 CancelToken 时继承任务组的, group.cancel() 可以中止所有任务;
+     * 等待任务组的协程被取消时也会取消整个任务组
+     */
+    struct TaskGroup {
+        TaskGroup() noexcept = default;
+
+        TaskGroup(TaskGroup &&) = delete;
+
+        ~TaskGroup() {
+            while (TaskGroupPromise *promise = m_head) {
+                unlink(*promise);
+                std::coroutine_handle<TaskGroupPromise>::from_promise(*promise).destroy();
+            }
+        }
+
+        /**
+         * 接管任务并立即开始运行, 直到它第一次挂起
+         */
+        template <class T, class P>
+        void spawn(Task<T, P> task) {
+            auto coroutine = runTask(*this, std::move(task)).mCoroutine;
+            auto &promise = coroutine.promise();
+            promise.mGroup = this;
+            promise.mCancelToken = m_cancel.token();
+            link(promise);
+            FrameArena::resume(coroutine);
+        }
+
+        /* 还没有结束的任务数 */
+        std::size_t size() const noexcept {
+            return m_count;
+        }
+
+        bool empty() const noexcept {
+            return m_count == 0;
+        }
+
+        /**
+         * 取消组内所有继承了任务组 CancelToken 的任务
+         */
+        void cancel() {
+            m_cancel.cancel();
+        }
+
+        CancelToken token() noexcept {
+            return m_cancel.token();
+        }
+
+        struct Awaiter {
+            bool await_ready() const noexcept {
+                return mGroup.m_count == 0;
+            }
+
+            template <class P>
+            bool await_suspend(std::coroutine_handle<P> coroutine) {
+                mArena.save();
+                CancelToken token = cancelTokenOf(coroutine);
+                if (token.cancelled()) [[unlikely]] {
+                    mGroup.cancel();
+                    if (mGroup.m_count == 0) {
+                        return false;
+                    }
+                }
+                mGroup.m_waiter = coroutine;
+                mCancelNode.link(token.state(), &Awaiter::onCancel, this);
+                return true;
+            }
+
+            /**
+             * 所有任务都已结束, 任务组可以继续使用
+             */
+            void await_resume() {
+                mArena.restore();
+                mCancelNode.unlink();
+                mGroup.m_cancel.reset();
+                if (auto exception = std::exchange(mGroup.m_exception, nullptr)) [[unlikely]] {
+                    std::rethrow_exception(exception);
+                }
+            }
+
+            static void onCancel(void *context) {
+                static_cast<Awaiter *>(context)->mGroup.cancel();
+            }
+
+            Awaiter(TaskGroup &group) noexcept : mGroup(group) {}
+
+            Awaiter(Awaiter &&) = delete;
+
+            TaskGroup &mGroup;
+            CancelNode mCancelNode;
+            ArenaResume mArena;
+        };
+
+        Awaiter operator co_await() noexcept {
+            return Awaiter(*this);
+        }
+
+    private:
+        friend struct TaskGroupPromise;
+
+        template <class T, class P>
+        static TaskGroupTask runTask(TaskGroup &group, Task<T, P> task) {
+            try {
+                co_await task;
+            } catch (...) {
+                group.fail(std::current_exception());
+            }
+        }
+
+        void link(TaskGroupPromise &promise) noexcept {
+            promise.mPrev = nullptr;
+            promise.mNext = m_head;
+            if (m_head) {
+                m_head->mPrev = &promise;
+            }
+            m_head = &promise;
+            ++m_count;
+        }
+
+        void unlink(TaskGroupPromise &promise) noexcept {
+            if (promise.mPrev) {
+                promise.mPrev->mNext = promise.mNext;
+            } else {
+                m_head = promise.mNext;
+            }
+            if (promise.mNext) {
+                promise.mNext->mPrev = promise.mPrev;
+            }
+            --m_count;
+        }
+
+        /* 只保留第一个异常, 其余任务多半是因此被取消的 */
+        void fail(std::exception_ptr exception) {
+            if (!m_exception) {
+                m_exception = std::move(exception);
+                m_cancel.cancel();
+            }
+        }
+
+        /**
+         * 最后一个任务结束时恢复等待任务组的协程
+         */
+        std::coroutine_handle<> onTaskDone() noexcept {
+            if (m_count == 0 && m_waiter) {
+                return std::exchange(m_waiter, nullptr);
+            }
+            return std::noop_coroutine();
+        }
+
+        TaskGroupPromise *m_head = nullptr;
+        std::size_t m_count = 0;
+        std::coroutine_handle<> m_waiter;
+        std::exception_ptr m_exception;
+        CancelSource m_cancel;
+    };
+
+    std::coroutine_handle<>
+    TaskGroupPromise::FinalAwaiter::await_suspend(std::coroutine_handle<TaskGroupPromise> coroutine) const noexcept {
+        TaskGroup &group = *coroutine.promise().mGroup;
+        group.unlink(coroutine.promise());
+        coroutine.destroy();
+        return group.onTaskDone();
+    }
+
+} // namespace co_async
@@ -1,111 +1,747 @@
 #pragma once
 #include "rbtree.hpp"
+#include "dary_heap.hpp"
+#include "pairing_heap.hpp"
 #include "task.hpp"
-#include <optional>
+#include "timing_wheel.hpp"
+#include <algorithm>
+#include <cassert>
 #include <chrono>
+#include <cstddef>
+#include <optional>
+#include <time.h>
 namespace co_async {
 
-struct SleepUntilPromise : RbTree<SleepUntilPromise>::RbNode, Promise<void> {
-    /* 储存计时器的过期时间点 */
-    std::chrono::system_clock::time_point mExpireTime;
+/**
+ * 基于 CLOCK_MONOTONIC_COARSE 的时钟, 读取开销远小于 steady_clock, 但精度只有一个时钟节拍(通常 1~4ms)
+ * 与 steady_clock 共用时间点类型, 两者的时间点可以直接比较
+ */
+struct CoarseSteadyClock {
+    using duration = std::chrono::nanoseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<std::chrono::steady_clock, duration>;
+    static constexpr bool is_steady = true;
+
+    static time_point now() noexcept {
+        struct timespec spec;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &spec);
+        return time_point(std::chrono::seconds(spec.tv_sec)
+                          + std::chrono::nanoseconds(spec.tv_nsec));
+    }
+
+    /* 一个时钟节拍的长度, now() 最多落后真实时间这么多 */
+    static duration resolution() noexcept {
+        static duration const tick = [] {
+            struct timespec spec;
+            clock_getres(CLOCK_MONOTONIC_COARSE, &spec);
+            return std::chrono::seconds(spec.tv_sec) + std::chrono::nanoseconds(spec.tv_nsec);
+        }();
+        return tick;
+    }
+};
+
+/**
+ * 只有在被推进时才前进的虚拟时钟, 用于确定性的模拟和压测
+ * 以它为时钟的 TimerLoop 不会等待, 而是直接把时间推进到下一个定时器的到期时间,
+ * 数小时的重试和超时可以在几毫秒内模拟完
+ * 时间是线程局部的, 同一个线程里的所有循环共用一个虚拟时间
+ */
+struct VirtualClock {
+    using duration = std::chrono::nanoseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<VirtualClock, duration>;
+    static constexpr bool is_steady = true;
+    static constexpr bool is_virtual = true;
+
+    static time_point now() noexcept {
+        return tNow;
+    }
+
+    /**
+     * 把时间推进到 time, 不会倒退
+     */
+    static void advanceTo(time_point time) noexcept {
+        if (tNow < time) {
+            tNow = time;
+        }
+    }
+
+    static void advance(duration duration) noexcept {
+        advanceTo(tNow + duration);
+    }
 
+    /**
+     * 重新开始一次模拟, 只能在没有定时器时调用
+     */
+    static void reset(time_point time = time_point()) noexcept {
+        tNow = time;
+    }
+
+private:
+    static inline thread_local time_point tNow{};
+};
+
+struct SleepUntilPromise : Promise<void> {
     auto get_return_object() {
         return std::coroutine_handle<SleepUntilPromise>::from_promise(*this);
     }
 
     SleepUntilPromise &operator=(SleepUntilPromise &&) = delete;
+};
+
+/**
+ * 以红黑树为存储的定时器队列, 按过期时间排序, 插入和删除都是 O(log n)
+ * Entry 需要继承 OrderedTimerQueue<Entry>::Node, 并且可以用 operator< 比较过期时间
+ */
+template <class Entry>
+struct OrderedTimerQueue {
+    using Node = typename RbTree<Entry>::RbNode;
+
+    void insert(Entry &entry) noexcept {
+        m_tree.insert(entry);
+    }
+
+    void erase(Entry &entry) noexcept {
+        m_tree.erase(entry);
+    }
+
+    bool empty() const noexcept {
+        return m_tree.empty();
+    }
 
     /**
-     * 比较两个对象的过期时间, 方便红黑树排序
-     * @return
+     * 依次把过期时间不晚于 now 的定时器摘下交给 visitor
      */
-    friend bool operator<(SleepUntilPromise const &lhs,
-                          SleepUntilPromise const &rhs) noexcept {
-        return lhs.mExpireTime < rhs.mExpireTime;
+    template <class TimePoint, class Visitor>
+    void expire(TimePoint now, Visitor &&visitor) {
+        while (!m_tree.empty()) {
+            auto &entry = m_tree.front();
+            if (now < entry.m_expireTime) {
+                break;
+            }
+            m_tree.erase(entry);
+            visitor(entry);
+        }
+    }
+
+    template <class TimePoint>
+    std::optional<TimePoint> next() const noexcept {
+        if (m_tree.empty()) {
+            return std::nullopt;
+        }
+        return m_tree.front().m_expireTime;
+    }
+
+private:
+    RbTree<Entry> m_tree;
+};
+
+/**
+ * 以最小堆为存储的定时器队列, Heap 是 DaryHeap 或 PairingHeap
+ * 超时大多是 "插入很多, 每次取最早的" 模式, 堆比红黑树的缓存局部性更好
+ */
+template <class Heap>
+struct BasicHeapTimerQueue {
+    using Node = typename Heap::Node;
+
+    template <class Entry>
+    void insert(Entry &entry) {
+        m_heap.insert(entry);
+    }
+
+    template <class Entry>
+    void erase(Entry &entry) noexcept {
+        m_heap.erase(entry);
+    }
+
+    bool empty() const noexcept {
+        return m_heap.empty();
+    }
+
+    template <class TimePoint, class Visitor>
+    void expire(TimePoint now, Visitor &&visitor) {
+        while (!m_heap.empty()) {
+            auto &entry = m_heap.front();
+            if (now < entry.m_expireTime) {
+                break;
+            }
+            m_heap.popFront();
+            visitor(entry);
+        }
     }
+
+    template <class TimePoint>
+    std::optional<TimePoint> next() const noexcept {
+        if (m_heap.empty()) {
+            return std::nullopt;
+        }
+        return m_heap.front().m_expireTime;
+    }
+
+private:
+    Heap m_heap;
 };
 
-struct TimerLoop {
-    RbTree<SleepUntilPromise> m_RBTimer;
+/* 4 叉堆, 节点在数组中连续存放 */
+template <class Entry>
+using HeapTimerQueue = BasicHeapTimerQueue<DaryHeap<Entry>>;
+
+/* 配对堆, 插入 O(1) 且不分配内存 */
+template <class Entry>
+using PairingTimerQueue = BasicHeapTimerQueue<PairingHeap<Entry>>;
+
+struct TimerLoopStats {
+    /* 有定时器到期的轮数, 即定时器造成的唤醒次数 */
+    std::size_t wakeups = 0;
+    std::size_t fired = 0;
+
+    /* 每次唤醒平均处理的定时器数, 开启合并后应当明显大于 1 */
+    double firedPerWakeup() const noexcept {
+        return wakeups ? (double) fired / (double) wakeups : 0.0;
+    }
+};
+
+/**
+ * 定时器循环, Queue 选择存储定时器的结构: OrderedTimerQueue(红黑树)、HeapTimerQueue(4 叉堆)、
+ * PairingTimerQueue(配对堆) 或 TimingWheel(时间轮)
+ * Clock 必须是单调时钟, 系统时间被 NTP 等调整时不会让定时器集体提前或推迟;
+ * 只需要毫秒级精度的超时可以使用 CoarseSteadyClock, 模拟和压测可以使用 VirtualClock
+ */
+template <template <class> class Queue = OrderedTimerQueue, class Clock = std::chrono::steady_clock>
+struct BasicTimerLoop {
+    static_assert(Clock::is_steady);
+
+    using TimerLoopType = BasicTimerLoop;
+    using ClockType = Clock;
+    /* 时钟是否为 VirtualClock 这样只能手动推进的虚拟时钟 */
+    static constexpr bool kVirtualClock = requires { requires Clock::is_virtual; };
+
+    /**
+     * 定时器节点, 嵌入在挂起中的等待者里, 协程被销毁时随之从队列中摘除
+     */
+    struct TimerNode : Queue<TimerNode>::Node {
+        /* 储存计时器的过期时间点 */
+        typename ClockType::time_point m_expireTime;
+        std::coroutine_handle<> m_coroutine;
+        /* 不为空时到期调用它, 而不是恢复 m_coroutine */
+        void (*m_callback)(TimerNode &node) = nullptr;
+        /* 是否在队列中等待到期 */
+        bool m_pending = false;
+
+        /**
+         * 比较两个对象的过期时间, 方便红黑树排序
+         * @return
+         */
+        friend bool operator<(TimerNode const &lhs, TimerNode const &rhs) noexcept {
+            return lhs.m_expireTime < rhs.m_expireTime;
+        }
+    };
 
     bool hasEvent() const noexcept {
-        return !m_RBTimer.empty();
+        return !m_queue.empty();
     }
 
     /**
-     * 加入到红黑树中, 注册一个新的定时器
-     * @param promise
+     * 注册一个新的定时器
+     * @param node
      */
-    void addTimer(SleepUntilPromise &promise) {
-        m_RBTimer.insert(promise);
+    void addTimer(TimerNode &node) {
+        /* 4 叉堆插入时可能扩容失败, 成功之后才标记为等待中 */
+        m_queue.insert(node);
+        node.m_pending = true;
+    }
+
+    /**
+     * 从队列中摘除一个还没有到期的定时器, 不恢复任何协程
+     * 红黑树中为 O(log n), 时间轮中为 O(1)
+     */
+    void cancelTimer(TimerNode &node) noexcept {
+        if (node.m_pending) {
+            node.m_pending = false;
+            m_queue.erase(node);
+        }
+    }
+
+    /**
+     * 设置合并定时器的容许延迟, 与内核的 timer slack 类似
+     * 循环等到最早的定时器到期后再过 slack 才唤醒, 这段窗口内到期的定时器在同一次唤醒中处理
+     * 每个定时器最多推迟 slack, 默认为 0 即不合并
+     */
+    void setSlack(typename ClockType::duration slack) noexcept {
+        m_slack = std::max(slack, ClockType::duration::zero());
+    }
+
+    typename ClockType::duration slack() const noexcept {
+        return m_slack;
+    }
+
+    TimerLoopStats const &stats() const noexcept {
+        return m_stats;
+    }
+
+    /**
+     * 本轮循环开始时的时间, 所有到期检查共用这一次采样
+     */
+    typename ClockType::time_point now() const noexcept {
+        return m_now;
+    }
+
+    /**
+     * 单独使用定时器循环时的一轮: 处理到期的定时器, 返回下一个定时器的剩余时间
+     * 虚拟时钟没有其他事件来源, 等待就等于直接跳到到期时间, 下一轮立即处理
+     * 取消回调也在这里调用, 本轮中又有新的取消时不等待
+     */
+    std::optional<typename ClockType::duration> run() {
+        CancelState::runPending();
+        auto timeout = runExpired();
+        if (timeout && CancelState::hasPending()) {
+            return ClockType::duration::zero();
+        }
+        if constexpr (kVirtualClock) {
+            if (timeout) {
+                ClockType::advance(*timeout);
+                return ClockType::duration::zero();
+            }
+        }
+        return timeout;
     }
 
     /**
      * 负责检查定时器是否到期
-     * 循环遍历红黑树, 检查当前时间与定时器的过期时间
-     * 如果过期时间到达, 则从树中删除相应的 promise, 并恢复对应的协程
-     * 如果没有定时器到期, 则返回下一个定时器的剩余时间, 方便调度
-     */
-    std::optional<std::chrono::system_clock::duration> run() {
-        while (!m_RBTimer.empty()) {
-            auto now = std::chrono::system_clock::now();
-            auto &promise = m_RBTimer.front();
-            if (promise.mExpireTime < now) {
-                m_RBTimer.erase(promise);
-                std::coroutine_handle<SleepUntilPromise>::from_promise(promise)
-                .resume();
+     * 每轮只读取一次时钟, 从队列中取出所有已经过期的定时器, 并恢复对应的协程
+     * 之后返回下一个定时器的剩余时间, 方便调度; 不会推进虚拟时钟
+     * 恢复的协程可能运行了一段时间, 这时重新采样, 避免算出的超时偏长
+     * 粗粒度时钟(提供 resolution())的读数最多落后一个节拍, 剩余时间要再加上一个节拍,
+     * 否则等待结束时读到的时间可能还没到, 循环会反复提前醒来
+     */
+    std::optional<typename ClockType::duration> runExpired() {
+        m_now = ClockType::now();
+        std::size_t fired = 0;
+        m_queue.expire(m_now, [&fired](TimerNode &node) {
+            ++fired;
+            node.m_pending = false;
+            if (node.m_callback) {
+                node.m_callback(node);
             } else {
-                return promise.mExpireTime - now;
+                FrameArena::resume(node.m_coroutine);
             }
+        });
+        if (fired) {
+            ++m_stats.wakeups;
+            m_stats.fired += fired;
+        }
+        auto next = m_queue.template next<typename ClockType::time_point>();
+        if (!next) {
+            return std::nullopt;
+        }
+        if (fired) {
+            m_now = ClockType::now();
+        }
+        auto timeout = *next + m_slack - m_now;
+        if (timeout <= ClockType::duration::zero()) {
+            return ClockType::duration::zero();
         }
-        return std::nullopt;
-     }
+        if constexpr (requires { ClockType::resolution(); }) {
+            timeout += ClockType::resolution();
+        }
+        return timeout;
+    }
+
+    BasicTimerLoop &operator=(BasicTimerLoop &&) = delete;
 
-     TimerLoop& operator=(TimerLoop&&) = delete;
+private:
+    Queue<TimerNode> m_queue;
+    typename ClockType::time_point m_now = ClockType::now();
+    typename ClockType::duration m_slack{};
+    TimerLoopStats m_stats;
 };
 
+using TimerLoop = BasicTimerLoop<>;
+/* 大量定时器频繁增删时(例如请求超时)使用时间轮, 精度为 1ms */
+using WheelTimerLoop = BasicTimerLoop<TimingWheel>;
+using HeapTimerLoop = BasicTimerLoop<HeapTimerQueue>;
+using PairingTimerLoop = BasicTimerLoop<PairingTimerQueue>;
+/* 只需要毫秒级精度的超时, 读取时钟的开销更小 */
+using CoarseTimerLoop = BasicTimerLoop<OrderedTimerQueue, CoarseSteadyClock>;
+/* 时间直接跳到下一个到期时间的模拟循环 */
+using VirtualTimerLoop = BasicTimerLoop<OrderedTimerQueue, VirtualClock>;
+
+template <class TimerLoopType>
 struct SleepAwaiter {
 private:
-    TimerLoop &mLoop;
-    std::chrono::system_clock::time_point mExpireTime;
+    TimerLoopType &mLoop;
+    typename TimerLoopType::TimerNode mNode;
 
 public:
-    SleepAwaiter(TimerLoop &mLoop, const std::chrono::system_clock::time_point &mExpireTime) :
-            mLoop(mLoop), mExpireTime(mExpireTime) {}
+    using ClockType = typename TimerLoopType::ClockType;
 
-    using ClockType = std::chrono::system_clock;
+    SleepAwaiter(TimerLoopType &mLoop, const typename ClockType::time_point &mExpireTime) :
+            mLoop(mLoop) {
+        mNode.m_expireTime = mExpireTime;
+    }
 
     bool await_ready() const noexcept { return false; }
 
-    void await_resume() const noexcept {}
+    void await_resume() {
+        mArena.restore();
+        mCancelNode.unlink();
+        if (mCancelled) [[unlikely]] {
+            throwCancelled();
+        }
+    }
 
     /**
      * 在协程挂起时被调用
-     * 它将过期时间设置到对应的 SleepUntilPromise 对象中
-     * 并将该对象添加到 TimerLoop 中
+     * 将嵌入在等待者中的定时器节点添加到 TimerLoop 中
      * 当协程被挂起时它会注册一个定时器, 以便在到达指定时间后恢复执行。
+     * 节点随等待者一起保存在协程帧里, 协程在等待期间被销毁时节点的析构函数会把它摘除
+     * 协程关联的 CancelToken 被取消时摘除定时器并提前恢复, await_resume 抛出 operation_canceled
      * @param coroutine
      */
-    void await_suspend(std::coroutine_handle<SleepUntilPromise> coroutine) {
-        auto& promise = coroutine.promise();
-        promise.mExpireTime = mExpireTime;
-        mLoop.addTimer(promise);
+    template <class P>
+    bool await_suspend(std::coroutine_handle<P> coroutine) {
+        mArena.save();
+        CancelToken token = cancelTokenOf(coroutine);
+        if (token.cancelled()) [[unlikely]] {
+            mCancelled = true;
+            return false;
+        }
+        mNode.m_coroutine = coroutine;
+        mLoop.addTimer(mNode);
+        mCancelNode.link(token.state(), &SleepAwaiter::onCancel, this);
+        return true;
+    }
+
+private:
+    static void onCancel(void *context) {
+        auto &awaiter = *static_cast<SleepAwaiter *>(context);
+        awaiter.mLoop.cancelTimer(awaiter.mNode);
+        awaiter.mCancelled = true;
+        FrameArena::resume(awaiter.mNode.m_coroutine);
+    }
+
+    CancelNode mCancelNode;
+    ArenaResume mArena;
+    bool mCancelled = false;
+};
+
+/**
+ * 可以取消、可以重新设定过期时间的定时器句柄, 节点保存在句柄自身中, 不需要协程帧
+ * 典型用法是每个请求一个截止时间: 请求完成时 cancel, 定时器不会在队列中残留
+ *
+ *     Timer timer(loop);
+ *     timer.expiresAfter(5s);
+ *     co_await when_any(handleRequest(), timer);
+ *
+ * co_await 一个句柄会挂起直到到期; 等待者在到期之前被销毁(例如 when_any 中落败的一方)时自动取消
+ * cancel 不会恢复正在等待的协程, 由调用者负责它的去留
+ */
+template <class TimerLoopType>
+struct Timer {
+    using ClockType = typename TimerLoopType::ClockType;
+
+    explicit Timer(TimerLoopType &loop) noexcept : mLoop(loop) {}
+
+    Timer(Timer &&) = delete;
+
+    ~Timer() {
+        cancel();
+    }
+
+    /**
+     * 设定过期时间, 已经在等待中的定时器按新的时间重新排队
+     */
+    void expiresAt(typename ClockType::time_point expireTime) {
+        if (mNode.m_pending) {
+            mLoop.cancelTimer(mNode);
+            mNode.m_expireTime = expireTime;
+            mLoop.addTimer(mNode);
+        } else {
+            mNode.m_expireTime = expireTime;
+        }
+    }
+
+    template <class Rep, class Period>
+    void expiresAfter(std::chrono::duration<Rep, Period> duration) {
+        expiresAt(ClockType::now() + std::chrono::duration_cast<typename ClockType::duration>(duration));
+    }
+
+    typename ClockType::time_point expireTime() const noexcept {
+        return mNode.m_expireTime;
+    }
+
+    bool pending() const noexcept {
+        return mNode.m_pending;
+    }
+
+    /**
+     * @return 定时器是否还在等待中(即取消是否生效)
+     */
+    bool cancel() noexcept {
+        bool pending = mNode.m_pending;
+        mLoop.cancelTimer(mNode);
+        return pending;
+    }
+
+    struct Awaiter {
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        template <class P>
+        bool await_suspend(std::coroutine_handle<P> coroutine) {
+            mArena.save();
+            CancelToken token = cancelTokenOf(coroutine);
+            if (token.cancelled()) [[unlikely]] {
+                mCancelled = true;
+                return false;
+            }
+            mTimer.mNode.m_coroutine = coroutine;
+            mTimer.mLoop.addTimer(mTimer.mNode);
+            mCoroutine = coroutine;
+            mCancelNode.link(token.state(), &Awaiter::onCancel, this);
+            return true;
+        }
+
+        void await_resume() {
+            mArena.restore();
+            mCancelNode.unlink();
+            if (mCancelled) [[unlikely]] {
+                throwCancelled();
+            }
+        }
+
+        /* 被取消时定时器不再等待, 之后可以重新设定并等待 */
+        static void onCancel(void *context) {
+            auto &awaiter = *static_cast<Awaiter *>(context);
+            awaiter.mTimer.cancel();
+            awaiter.mCancelled = true;
+            FrameArena::resume(awaiter.mCoroutine);
+        }
+
+        Awaiter(Timer &timer) noexcept : mTimer(timer) {}
+
+        Awaiter(Awaiter &&) = delete;
+
+        /* 等待中的协程被销毁时, 不能让定时器到期后恢复一个已经不存在的协程 */
+        ~Awaiter() {
+            if (mCoroutine && mTimer.mNode.m_pending && mTimer.mNode.m_coroutine == mCoroutine) {
+                mTimer.cancel();
+            }
+        }
+
+        Timer &mTimer;
+        std::coroutine_handle<> mCoroutine;
+        CancelNode mCancelNode;
+        ArenaResume mArena;
+        bool mCancelled = false;
+    };
+
+    Awaiter operator co_await() noexcept {
+        return Awaiter(*this);
+    }
+
+private:
+    TimerLoopType &mLoop;
+    typename TimerLoopType::TimerNode mNode;
+};
+
+template <class Loop>
+Timer(Loop &) -> Timer<typename Loop::TimerLoopType>;
+
+/**
+ * 周期定时器错过了若干次到期(例如协程处理得太久)时的处理方式
+ */
+enum class MissedTick {
+    /* 立即补上所有错过的到期, 之后仍然对齐到原来的时间点 */
+    Burst,
+    /* 丢弃错过的到期, 下一次对齐到原来节奏中晚于现在的第一个时间点 */
+    Skip,
+    /* 从现在起重新计时, 之后的时间点整体推迟 */
+    Delay,
+};
+
+/**
+ * 周期定时器, 按固定的绝对时间点到期, 不会像循环调用 sleep_for 那样累积误差
+ * 每次 co_await 复用句柄中的同一个定时器节点, 不需要分配协程帧
+ *
+ *     Interval interval(loop, 100ms);
+ *     while (true) {
+ *         co_await interval;
+ *         flush();
+ *     }
+ *
+ * co_await 的结果是这一次计划的到期时间点; 已经过了到期时间时不会挂起
+ * 只有一个定时器节点, 同一时间只能有一个协程在等待它, 调试模式下断言这一点
+ */
+template <class TimerLoopType>
+struct Interval {
+    using ClockType = typename TimerLoopType::ClockType;
+
+    /**
+     * 第一次在 period 之后到期
+     */
+    template <class Rep, class Period>
+    Interval(TimerLoopType &loop, std::chrono::duration<Rep, Period> period,
+             MissedTick missedTick = MissedTick::Burst) noexcept
+            : mLoop(loop),
+              mPeriod(std::max(std::chrono::duration_cast<typename ClockType::duration>(period),
+                               typename ClockType::duration(1))),
+              mMissedTick(missedTick) {
+        mNode.m_expireTime = ClockType::now() + mPeriod;
+    }
+
+    Interval(Interval &&) = delete;
+
+    ~Interval() {
+        mLoop.cancelTimer(mNode);
+    }
+
+    typename ClockType::duration period() const noexcept {
+        return mPeriod;
+    }
+
+    /**
+     * 下一次到期的时间点
+     */
+    typename ClockType::time_point expireTime() const noexcept {
+        return mNode.m_expireTime;
+    }
+
+    void setMissedTick(MissedTick missedTick) noexcept {
+        mMissedTick = missedTick;
     }
+
+    /**
+     * 从现在起重新计时, 下一次在 period 之后到期
+     */
+    void reset() {
+        bool pending = mNode.m_pending;
+        mLoop.cancelTimer(mNode);
+        mNode.m_expireTime = ClockType::now() + mPeriod;
+        if (pending) {
+            mLoop.addTimer(mNode);
+        }
+    }
+
+    struct Awaiter {
+        bool await_ready() const noexcept {
+            return ClockType::now() >= mInterval.mNode.m_expireTime;
+        }
+
+        template <class P>
+        bool await_suspend(std::coroutine_handle<P> coroutine) {
+            mArena.save();
+            CancelToken token = cancelTokenOf(coroutine);
+            if (token.cancelled()) [[unlikely]] {
+                mCancelled = true;
+                return false;
+            }
+            assert(!mInterval.mNode.m_pending && "Interval awaited by two coroutines at once");
+            mInterval.mNode.m_coroutine = coroutine;
+            mInterval.mLoop.addTimer(mInterval.mNode);
+            mCoroutine = coroutine;
+            mCancelNode.link(token.state(), &Awaiter::onCancel, this);
+            return true;
+        }
+
+        /**
+         * 被取消时抛出 operation_canceled, 不推进计划的时间点
+         */
+        typename ClockType::time_point await_resume() {
+            mArena.restore();
+            mCoroutine = nullptr;
+            mCancelNode.unlink();
+            if (mCancelled) [[unlikely]] {
+                throwCancelled();
+            }
+            return mInterval.advance();
+        }
+
+        static void onCancel(void *context) {
+            auto &awaiter = *static_cast<Awaiter *>(context);
+            awaiter.mInterval.mLoop.cancelTimer(awaiter.mInterval.mNode);
+            awaiter.mCancelled = true;
+            FrameArena::resume(awaiter.mCoroutine);
+        }
+
+        Awaiter(Interval &interval) noexcept : mInterval(interval) {}
+
+        Awaiter(Awaiter &&) = delete;
+
+        ~Awaiter() {
+            if (mCoroutine && mInterval.mNode.m_pending && mInterval.mNode.m_coroutine == mCoroutine) {
+                mInterval.mLoop.cancelTimer(mInterval.mNode);
+            }
+        }
+
+        Interval &mInterval;
+        std::coroutine_handle<> mCoroutine;
+        CancelNode mCancelNode;
+        ArenaResume mArena;
+        bool mCancelled = false;
+    };
+
+    Awaiter operator co_await() noexcept {
+        return Awaiter(*this);
+    }
+
+private:
+    /**
+     * 按照错过到期的处理方式计算下一个时间点
+     * @return 刚刚到期的这一次计划的时间点
+     */
+    typename ClockType::time_point advance() noexcept {
+        auto tick = mNode.m_expireTime;
+        auto next = tick + mPeriod;
+        if (mMissedTick != MissedTick::Burst) {
+            auto now = ClockType::now();
+            if (next <= now) {
+                if (mMissedTick == MissedTick::Skip) {
+                    next += mPeriod * ((now - next) / mPeriod + 1);
+                } else {
+                    next = now + mPeriod;
+                }
+            }
+        }
+        mNode.m_expireTime = next;
+        return tick;
+    }
+
+    TimerLoopType &mLoop;
+    typename TimerLoopType::TimerNode mNode;
+    typename ClockType::duration mPeriod;
+    MissedTick mMissedTick;
 };
 
-template<class Clock, class Duration>
+template <class Loop, class Rep, class Period>
+Interval(Loop &, std::chrono::duration<Rep, Period>) -> Interval<typename Loop::TimerLoopType>;
+
+template <class Loop, class Rep, class Period>
+Interval(Loop &, std::chrono::duration<Rep, Period>, MissedTick) -> Interval<typename Loop::TimerLoopType>;
+
+/**
+ * loop 可以是 TimerLoop 本身, 也可以是能转换为 Loop::TimerLoopType& 的 AsyncLoop
+ */
+template<class Loop, class Clock, class Duration>
 inline Task<void, SleepUntilPromise>
-sleep_until(TimerLoop& loop, std::chrono::time_point<Clock, Duration> expireTime) {
-    co_await SleepAwaiter(loop,
-              std::chrono::time_point_cast<SleepAwaiter::ClockType::duration>(expireTime));
+sleep_until(Loop& loop, std::chrono::time_point<Clock, Duration> expireTime) {
+    using TimerLoopType = typename Loop::TimerLoopType;
+    using ClockType = typename TimerLoopType::ClockType;
+    co_await SleepAwaiter<TimerLoopType>(loop,
+              std::chrono::time_point_cast<typename ClockType::duration>(expireTime));
 }
 
-template<class Rep, class Period>
+template<class Loop, class Rep, class Period>
 inline Task<void, SleepUntilPromise>
-sleep_for(TimerLoop& loop, std::chrono::duration<Rep, Period> duration) {
-    auto d = std::chrono::duration_cast<SleepAwaiter::ClockType::duration>(duration);
+sleep_for(Loop& loop, std::chrono::duration<Rep, Period> duration) {
+    using TimerLoopType = typename Loop::TimerLoopType;
+    using ClockType = typename TimerLoopType::ClockType;
+    auto d = std::chrono::duration_cast<typename ClockType::duration>(duration);
     if (d.count() > 0) {
-        co_await SleepAwaiter(loop, SleepAwaiter::ClockType::now() + d);
+        co_await SleepAwaiter<TimerLoopType>(loop, ClockType::now() + d);
     }
 }
-}
\ No newline at end of file
+}
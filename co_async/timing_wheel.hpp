@@ -0,0 +1,285 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+namespace co_async {
+
+    /**
+     * 分层时间轮, 可以替代红黑树作为 BasicTimerLoop 的定时器队列
+     * 4 层, 每层 256 个槽, 以 1ms 为一个刻度, 覆盖约 49 天, 更远的定时器先放在最高层的最后一个槽,
+     * 到期时重新放置
+     * 插入和删除都是 O(1), 到期时整个槽一起处理; 代价是到期时间被向上取整到刻度, 最多晚 1ms
+     *
+     * Entry 需要继承 TimingWheel<Entry>::Node, 并且有 m_expireTime 成员
+     * 和 RbNode 一样, 节点析构时自动从时间轮中摘除
+     */
+    template <class Entry>
+    struct TimingWheel {
+        static constexpr std::chrono::milliseconds kResolution{1};
+
+        struct Node {
+            Node() noexcept = default;
+
+            Node(Node &&) = delete;
+
+            ~Node() noexcept {
+                if (m_wheel) {
+                    m_wheel->remove(*this);
+                }
+            }
+
+            friend struct TimingWheel;
+
+        private:
+            Node *m_prev = nullptr;
+            Node *m_next = nullptr;
+            TimingWheel *m_wheel = nullptr;
+            std::uint64_t m_tick = 0;
+        };
+
+        TimingWheel() noexcept = default;
+
+        TimingWheel(TimingWheel &&) = delete;
+
+        void insert(Entry &entry) noexcept {
+            Node &node = entry;
+            auto ticks = std::chrono::ceil<std::chrono::milliseconds>(
+                    entry.m_expireTime.time_since_epoch()).count();
+            node.m_tick = ticks > 0 ? static_cast<std::uint64_t>(ticks) : 0;
+            node.m_wheel = this;
+            ++m_size;
+            place(node);
+        }
+
+        void erase(Entry &entry) noexcept {
+            remove(entry);
+        }
+
+        bool empty() const noexcept {
+            return m_size == 0;
+        }
+
+        /**
+         * 推进到 now 所在的刻度, 依次把到期的定时器摘下交给 visitor
+         * visitor 中可以插入或者删除任意定时器
+         */
+        template <class TimePoint, class Visitor>
+        void expire(TimePoint now, Visitor &&visitor) {
+            auto ticks = std::chrono::floor<std::chrono::milliseconds>(now.time_since_epoch()).count();
+            std::uint64_t target = ticks > 0 ? static_cast<std::uint64_t>(ticks) : 0;
+            if (!m_synced) {
+                /* 第一次推进之前不知道当前刻度, 之前插入的定时器都暂存在 m_pending */
+                m_synced = true;
+                m_current = target;
+                List unplaced;
+                unplaced.takeFrom(m_pending);
+                while (!unplaced.empty()) {
+                    place(unplaced.popFront());
+                }
+            }
+            fire(visitor);
+            while (m_current < target) {
+                std::uint64_t tick = nextTick();
+                if (tick > target) {
+                    m_current = target;
+                    break;
+                }
+                m_current = tick;
+                for (std::size_t level = kLevels - 1; level > 0; --level) {
+                    if ((tick & ((std::uint64_t(1) << (kSlotBits * level)) - 1)) == 0) {
+                        cascade(level, slotIndex(tick, level));
+                    }
+                }
+                m_pending.takeFrom(m_slots[0][slotIndex(tick, 0)]);
+                fire(visitor);
+            }
+        }
+
+        /**
+         * 下一次需要推进的时间点, 可能早于真正最早的到期时间(高层的槽需要下放), 但不会晚于它
+         */
+        template <class TimePoint>
+        std::optional<TimePoint> next() const noexcept {
+            if (m_size == 0) {
+                return std::nullopt;
+            }
+            if (!m_pending.empty()) {
+                return TimePoint(std::chrono::duration_cast<typename TimePoint::duration>(
+                        kResolution * m_current));
+            }
+            return TimePoint(std::chrono::duration_cast<typename TimePoint::duration>(
+                    kResolution * nextTick()));
+        }
+
+    private:
+        static constexpr std::size_t kLevels = 4;
+        static constexpr std::size_t kSlotBits = 8;
+        static constexpr std::size_t kSlots = std::size_t(1) << kSlotBits;
+
+        /**
+         * 带哨兵的循环双向链表, 摘除节点不需要知道它在哪个链表中
+         */
+        struct List {
+            List() noexcept {
+                m_head.m_prev = m_head.m_next = &m_head;
+            }
+
+            List(List &&) = delete;
+
+            bool empty() const noexcept {
+                return m_head.m_next == &m_head;
+            }
+
+            void pushBack(Node &node) noexcept {
+                node.m_prev = m_head.m_prev;
+                node.m_next = &m_head;
+                m_head.m_prev->m_next = &node;
+                m_head.m_prev = &node;
+            }
+
+            Node &popFront() noexcept {
+                Node &node = *m_head.m_next;
+                unlink(node);
+                return node;
+            }
+
+            /* 把 that 中的节点全部移到本链表末尾 */
+            void takeFrom(List &that) noexcept {
+                if (that.empty()) return;
+                Node *first = that.m_head.m_next;
+                Node *last = that.m_head.m_prev;
+                first->m_prev = m_head.m_prev;
+                m_head.m_prev->m_next = first;
+                last->m_next = &m_head;
+                m_head.m_prev = last;
+                that.m_head.m_prev = that.m_head.m_next = &that.m_head;
+            }
+
+            Node m_head;
+        };
+
+        void remove(Node &node) noexcept {
+            unlink(node);
+            node.m_wheel = nullptr;
+            --m_size;
+        }
+
+        static void unlink(Node &node) noexcept {
+            node.m_prev->m_next = node.m_next;
+            node.m_next->m_prev = node.m_prev;
+            node.m_prev = node.m_next = nullptr;
+        }
+
+        static std::size_t slotIndex(std::uint64_t tick, std::size_t level) noexcept {
+            return (tick >> (kSlotBits * level)) & (kSlots - 1);
+        }
+
+        /**
+         * 按照与当前刻度的距离选择层: 第 level 层的槽在当前块之后 kSlots 个块以内
+         */
+        void place(Node &node) noexcept {
+            if (!m_synced || node.m_tick <= m_current) {
+                m_pending.pushBack(node);
+                return;
+            }
+            for (std::size_t level = 0; level < kLevels; ++level) {
+                std::size_t shift = kSlotBits * level;
+                if ((node.m_tick >> shift) - (m_current >> shift) < kSlots) {
+                    link(level, slotIndex(node.m_tick, level), node);
+                    return;
+                }
+            }
+            std::size_t top = kLevels - 1;
+            link(top, slotIndex((m_current >> (kSlotBits * top)) + kSlots - 1, 0), node);
+        }
+
+        void link(std::size_t level, std::size_t slot, Node &node) noexcept {
+            m_slots[level][slot].pushBack(node);
+            m_occupied[level][slot / 64] |= std::uint64_t(1) << (slot % 64);
+        }
+
+        void cascade(std::size_t level, std::size_t slot) noexcept {
+            List moving;
+            moving.takeFrom(m_slots[level][slot]);
+            while (!moving.empty()) {
+                place(moving.popFront());
+            }
+        }
+
+        template <class Visitor>
+        void fire(Visitor &visitor) {
+            while (!m_pending.empty()) {
+                Node &node = m_pending.popFront();
+                node.m_wheel = nullptr;
+                --m_size;
+                visitor(static_cast<Entry &>(node));
+            }
+        }
+
+        /**
+         * 各层中下一个非空槽开始处理的刻度的最小值
+         * 占用位图是惰性的: 节点被删除后槽可能已经空了, 在这里才清除对应的位
+         */
+        std::uint64_t nextTick() const noexcept {
+            std::uint64_t best = std::numeric_limits<std::uint64_t>::max();
+            for (std::size_t level = 0; level < kLevels; ++level) {
+                std::size_t shift = kSlotBits * level;
+                std::uint64_t block = m_current >> shift;
+                std::size_t current = block & (kSlots - 1);
+                for (std::size_t i = 1; i <= kSlots; ++i) {
+                    std::size_t slot = findOccupied(level, (current + i) & (kSlots - 1), i);
+                    if (slot == kSlots) break;
+                    if (m_slots[level][slot].empty()) {
+                        m_occupied[level][slot / 64] &= ~(std::uint64_t(1) << (slot % 64));
+                        i = ((slot - current - 1) & (kSlots - 1)) + 1;
+                        continue;
+                    }
+                    std::uint64_t distance = ((slot - current - 1) & (kSlots - 1)) + 1;
+                    best = std::min(best, (block + distance) << shift);
+                    break;
+                }
+            }
+            return best;
+        }
+
+        /**
+         * 从 from 开始(循环地)查找第一个占用的槽, 最多查找到 current 为止
+         * @param step 从 current 之后数起, from 是第几个槽
+         * @return 找不到时返回 kSlots
+         */
+        std::size_t findOccupied(std::size_t level, std::size_t from, std::size_t step) const noexcept {
+            std::size_t remaining = kSlots - step + 1;
+            std::size_t slot = from;
+            while (remaining != 0) {
+                std::size_t word = slot / 64;
+                std::uint64_t bits = m_occupied[level][word] >> (slot % 64);
+                std::size_t span = std::min<std::size_t>(64 - slot % 64, remaining);
+                if (bits != 0) {
+                    std::size_t offset = std::countr_zero(bits);
+                    if (offset < span) {
+                        return slot + offset;
+                    }
+                }
+                remaining -= span;
+                slot = (slot + span) & (kSlots - 1);
+            }
+            return kSlots;
+        }
+
+        std::array<std::array<List, kSlots>, kLevels> m_slots;
+        /* 每层 256 个槽的占用位图 */
+        mutable std::array<std::array<std::uint64_t, kSlots / 64>, kLevels> m_occupied{};
+        /* 已到期、等待交给 visitor 的定时器, 以及第一次推进之前插入的定时器 */
+        List m_pending;
+        std::uint64_t m_current = 0;
+        std::size_t m_size = 0;
+        bool m_synced = false;
+    };
+
+} // namespace co_async
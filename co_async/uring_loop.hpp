@@ -0,0 +1,659 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <vector>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "epoll_loop.hpp"
+
+namespace co_async {
+
+struct UringOpAwaiter;
+
+/**
+ * io_uring 的提交与收割计数
+ */
+struct UringLoopStats {
+    std::size_t enterCalls = 0;
+    std::size_t submitted = 0;
+    std::size_t completions = 0;
+    /* 销毁挂起的请求时, 因为它正在内核中执行而不得不阻塞等待的次数 */
+    std::size_t blockingWaits = 0;
+};
+
+/**
+ * 基于 io_uring 的完成式 I/O 循环, 直接用系统调用实现, 不依赖 liburing
+ * 读写请求先放入提交队列, 每轮循环开始时一次 io_uring_enter 批量提交;
+ * 完成队列的 fd 作为常驻监听者注册在 epoll 中, 可读时批量收割,
+ * 因此定时器、就绪事件与 io_uring 完成共享同一次等待
+ * 内核不支持 io_uring (或缺少所需的操作码) 时 supported() 为 false,
+ * read_file/write_file 退化为 EpollLoop 的就绪式读写
+ *
+ * 本库创建的 fd 都是非阻塞的. 较新的内核对支持 nowait 的 fd (socket, 管道) 忽略 O_NONBLOCK,
+ * 读不到数据时在内核中等待就绪后重试; 旧内核则直接以 -EAGAIN 完成.
+ * 第一次遇到 -EAGAIN 后循环改为在每个读写请求前链接一个 IORING_OP_POLL_ADD,
+ * 就绪等待同样在 io_uring 中完成, 不经过 epoll
+ */
+struct UringLoop : EpollLoop {
+    explicit UringLoop(unsigned entries = 256) {
+        setup(entries);
+    }
+
+    ~UringLoop() {
+        teardown();
+    }
+
+    UringLoop &operator=(UringLoop &&) = delete;
+
+    bool supported() const noexcept {
+        return m_ring != -1;
+    }
+
+    UringLoopStats const &uringStats() const noexcept {
+        return m_uringStats;
+    }
+
+    /**
+     * 读写请求之前是否链接一个 IORING_OP_POLL_ADD, 读写请求以 -EAGAIN 完成时自动开启
+     */
+    bool pollFirst() const noexcept {
+        return m_pollFirst;
+    }
+
+    void setPollFirst(bool pollFirst) noexcept {
+        m_pollFirst = pollFirst;
+    }
+
+    inline bool run(std::optional<std::chrono::nanoseconds> timeout = std::nullopt);
+    inline void submit(UringOpAwaiter &awaiter);
+    inline void cancel(UringOpAwaiter &awaiter);
+    inline bool requestCancel(UringOpAwaiter &awaiter);
+
+private:
+    /**
+     * user_data 的最高两位区分请求种类, 其余位是槽位或者取消请求的序号
+     * 取消请求和链接在读写之前的 poll 的完成事件不交给等待者
+     */
+    static constexpr std::uint64_t kCancelTag = std::uint64_t(1) << 63;
+    static constexpr std::uint64_t kPollTag = std::uint64_t(1) << 62;
+
+    inline void setup(unsigned entries);
+    inline void teardown() noexcept;
+    inline bool probe() const;
+    inline io_uring_sqe *nextSqe() noexcept;
+    inline void commitSqe() noexcept;
+    inline unsigned sqSpace() const noexcept;
+    inline bool pushSqe(UringOpAwaiter &awaiter);
+    inline std::uint64_t pushCancel(UringOpAwaiter &awaiter);
+    inline void flush();
+    inline std::size_t reap();
+    inline bool complete(std::uint64_t slot, int res);
+    inline void defer();
+    inline void enter();
+    inline bool deferred(std::uint64_t userData) const noexcept;
+    inline int waitCancel(std::uint64_t tag);
+    inline void waitFor(std::uint64_t slot);
+
+    static void onComplete(void *self) {
+        static_cast<UringLoop *>(self)->reap();
+    }
+
+    int m_ring = -1;
+    io_uring_params m_params{};
+    void *m_sqRing = MAP_FAILED;
+    void *m_cqRing = MAP_FAILED;
+    void *m_sqeMap = MAP_FAILED;
+    std::size_t m_sqRingSize = 0;
+    std::size_t m_cqRingSize = 0;
+    std::size_t m_sqeMapSize = 0;
+    unsigned *m_sqHead = nullptr;
+    unsigned *m_sqTail = nullptr;
+    unsigned *m_sqArray = nullptr;
+    unsigned m_sqMask = 0;
+    io_uring_sqe *m_sqes = nullptr;
+    unsigned *m_cqHead = nullptr;
+    unsigned *m_cqTail = nullptr;
+    unsigned m_cqMask = 0;
+    io_uring_cqe *m_cqes = nullptr;
+    /* 已写入提交队列但还没有 io_uring_enter 的请求数 */
+    unsigned m_toSubmit = 0;
+    /* user_data 即槽位下标; 等待者提前销毁时槽位置空, 保留到完成事件到达为止 */
+    std::vector<UringOpAwaiter *> m_slots;
+    std::vector<std::uint64_t> m_freeSlots;
+    /* 提交队列已满时暂存的请求, 下一轮循环开始时补交 */
+    std::vector<UringOpAwaiter *> m_backlog;
+    /* 已经从完成队列取出、还没有处理的完成事件 (user_data, 结果) */
+    std::vector<std::pair<std::uint64_t, int>> m_deferred;
+    /* 下一个取消请求的序号, 用来在完成队列中找到它自己的结果 */
+    std::uint64_t m_cancelSeq = 0;
+    bool m_pollFirst = false;
+    UringLoopStats m_uringStats;
+};
+
+/**
+ * 一次 io_uring 请求, 完成时恢复协程
+ * 与系统调用不同, await_resume 失败时返回 -errno
+ * 请求进入内核后等待者被销毁(例如 when_any 中落败的一方)时, 析构函数提交取消,
+ * 确认内核不会再访问缓冲区之后才返回, 协程帧中的缓冲区可以随之释放; 见 UringLoop::cancel
+ */
+struct UringOpAwaiter {
+    UringOpAwaiter(UringLoop &loop, std::uint8_t opcode, int fileno, void const *addr,
+                   std::uint32_t len, std::uint64_t offset = std::uint64_t(-1)) :
+            m_loop(loop), m_opcode(opcode), fileno(fileno), m_addr(addr), m_len(len), m_offset(offset) {}
+
+    UringOpAwaiter(UringOpAwaiter &&) = delete;
+
+    ~UringOpAwaiter() {
+        if (m_coroutine) {
+            m_loop.cancel(*this);
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    /**
+     * 协程关联的 CancelToken 被取消时立即向内核提交取消请求,
+     * 但要等原请求的完成事件到达、内核不再访问缓冲区之后才恢复, 结果为 -ECANCELED
+     */
+    template <class P>
+    bool await_suspend(std::coroutine_handle<P> coroutine) {
+        m_arena.save();
+        CancelToken token = cancelTokenOf(coroutine);
+        if (token.cancelled()) [[unlikely]] {
+            m_result = -ECANCELED;
+            return false;
+        }
+        m_coroutine = coroutine;
+        m_loop.submit(*this);
+        m_cancelNode.link(token.state(), &UringOpAwaiter::onCancel, this);
+        return true;
+    }
+
+    int await_resume() noexcept {
+        m_arena.restore();
+        m_cancelNode.unlink();
+        return m_result;
+    }
+
+    inline static void onCancel(void *context);
+
+    UringLoop &m_loop;
+    std::uint8_t m_opcode;
+    int fileno;
+    void const *m_addr;
+    std::uint32_t m_len;
+    std::uint64_t m_offset;
+    int m_result = 0;
+    std::uint64_t m_slot = 0;
+    /* 还在 m_backlog 中, 尚未进入提交队列 */
+    bool m_queued = false;
+    /* 已经提交了取消请求, 完成时结果一律为 -ECANCELED */
+    bool m_cancelled = false;
+    /* 请求之前链接了一个 IORING_OP_POLL_ADD */
+    bool m_linked = false;
+    std::coroutine_handle<> m_coroutine;
+    CancelNode m_cancelNode;
+    ArenaResume m_arena;
+};
+
+void UringLoop::setup(unsigned entries) {
+    io_uring_params params{};
+    int ring = syscall(__NR_io_uring_setup, entries, &params);
+    if (ring == -1) return;
+    m_ring = ring;
+    m_params = params;
+    if (!probe()) {
+        teardown();
+        return;
+    }
+    m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap) {
+        m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+    }
+    m_sqRing = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+    if (m_sqRing == MAP_FAILED) {
+        teardown();
+        return;
+    }
+    if (singleMmap) {
+        m_cqRing = m_sqRing;
+    } else {
+        m_cqRing = mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+    }
+    m_sqeMapSize = params.sq_entries * sizeof(io_uring_sqe);
+    m_sqeMap = mmap(nullptr, m_sqeMapSize, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES);
+    if (m_cqRing == MAP_FAILED || m_sqeMap == MAP_FAILED) {
+        teardown();
+        return;
+    }
+    auto *sq = static_cast<char *>(m_sqRing);
+    auto *cq = static_cast<char *>(m_cqRing);
+    m_sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    m_sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    m_sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    m_sqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    m_sqes = static_cast<io_uring_sqe *>(m_sqeMap);
+    m_cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    m_cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    m_cqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    m_cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    addWatcher(m_ring, EPOLLIN, &UringLoop::onComplete, this);
+}
+
+void UringLoop::teardown() noexcept {
+    if (m_sqeMap != MAP_FAILED) munmap(m_sqeMap, m_sqeMapSize);
+    if (m_cqRing != MAP_FAILED && m_cqRing != m_sqRing) munmap(m_cqRing, m_cqRingSize);
+    if (m_sqRing != MAP_FAILED) munmap(m_sqRing, m_sqRingSize);
+    m_sqeMap = m_cqRing = m_sqRing = MAP_FAILED;
+    if (m_ring != -1) {
+        close(m_ring);
+        m_ring = -1;
+    }
+}
+
+/**
+ * 检查内核是否支持所需的操作码 (IORING_OP_READ/WRITE 需要 5.6 以上)
+ */
+bool UringLoop::probe() const {
+    constexpr unsigned kProbeOps = 256;
+    std::vector<unsigned char> buffer(sizeof(io_uring_probe) + kProbeOps * sizeof(io_uring_probe_op));
+    auto *probe = reinterpret_cast<io_uring_probe *>(buffer.data());
+    if (syscall(__NR_io_uring_register, m_ring, IORING_REGISTER_PROBE, probe, kProbeOps) == -1) {
+        return false;
+    }
+    if (!(m_params.features & IORING_FEAT_RW_CUR_POS)) return false;
+    for (unsigned op: {IORING_OP_READ, IORING_OP_WRITE, IORING_OP_ASYNC_CANCEL, IORING_OP_POLL_ADD}) {
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * 提交队列的尾指针只有本线程写, 头指针由内核推进
+ */
+io_uring_sqe *UringLoop::nextSqe() noexcept {
+    unsigned tail = *m_sqTail;
+    unsigned head = std::atomic_ref(*m_sqHead).load(std::memory_order_acquire);
+    if (tail - head >= m_params.sq_entries) return nullptr;
+    auto *sqe = &m_sqes[tail & m_sqMask];
+    std::memset(sqe, 0, sizeof(io_uring_sqe));
+    return sqe;
+}
+
+void UringLoop::commitSqe() noexcept {
+    unsigned tail = *m_sqTail;
+    m_sqArray[tail & m_sqMask] = tail & m_sqMask;
+    std::atomic_ref(*m_sqTail).store(tail + 1, std::memory_order_release);
+    ++m_toSubmit;
+}
+
+unsigned UringLoop::sqSpace() const noexcept {
+    unsigned head = std::atomic_ref(*m_sqHead).load(std::memory_order_acquire);
+    return m_params.sq_entries - (*m_sqTail - head);
+}
+
+/**
+ * 需要时在读写之前链接一个等待就绪的 poll, 两个 SQE 必须连续地放入提交队列
+ */
+bool UringLoop::pushSqe(UringOpAwaiter &awaiter) {
+    EpollEventMask events = 0;
+    if (m_pollFirst) {
+        if (awaiter.m_opcode == IORING_OP_READ) {
+            events = POLLIN | POLLRDHUP;
+        } else if (awaiter.m_opcode == IORING_OP_WRITE) {
+            events = POLLOUT;
+        }
+    }
+    unsigned needed = events ? 2 : 1;
+    if (sqSpace() < needed) {
+        flush();
+        if (sqSpace() < needed) return false;
+    }
+    if (m_freeSlots.empty()) {
+        m_freeSlots.push_back(m_slots.size());
+        m_slots.push_back(nullptr);
+    }
+    awaiter.m_slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+    m_slots[awaiter.m_slot] = &awaiter;
+    awaiter.m_linked = events != 0;
+    if (events) {
+        auto *poll = nextSqe();
+        poll->opcode = IORING_OP_POLL_ADD;
+        poll->fd = awaiter.fileno;
+        poll->poll32_events = events;
+        poll->flags = IOSQE_IO_LINK;
+        poll->user_data = kPollTag | awaiter.m_slot;
+        commitSqe();
+    }
+    auto *sqe = nextSqe();
+    sqe->opcode = awaiter.m_opcode;
+    sqe->fd = awaiter.fileno;
+    sqe->addr = reinterpret_cast<std::uintptr_t>(awaiter.m_addr);
+    sqe->len = awaiter.m_len;
+    sqe->off = awaiter.m_offset;
+    sqe->user_data = awaiter.m_slot;
+    commitSqe();
+    return true;
+}
+
+void UringLoop::submit(UringOpAwaiter &awaiter) {
+    retain();
+    if (!m_backlog.empty() || !pushSqe(awaiter)) {
+        awaiter.m_queued = true;
+        m_backlog.push_back(&awaiter);
+    }
+}
+
+/**
+ * 请求已经交给内核, 缓冲区多半就在即将释放的协程帧中
+ * 取消请求在提交时就在内核中执行完毕, 这里只等它自己的结果, 不恢复任何协程:
+ * 撤销成功(0)或者原请求的完成事件已经到达时, 内核都不会再访问缓冲区, 槽位留给之后的 reap 回收;
+ * 只有原请求正在 io-wq 中执行(-EALREADY)等少数情况, 才阻塞到它的完成事件到达
+ */
+void UringLoop::cancel(UringOpAwaiter &awaiter) {
+    if (awaiter.m_queued) {
+        std::erase(m_backlog, &awaiter);
+        release();
+        return;
+    }
+    m_slots[awaiter.m_slot] = nullptr;
+    int res = waitCancel(pushCancel(awaiter));
+    if (res != 0 && !deferred(awaiter.m_slot)) {
+        ++m_uringStats.blockingWaits;
+        waitFor(awaiter.m_slot);
+    }
+}
+
+void UringLoop::enter() {
+    int res = syscall(__NR_io_uring_enter, m_ring, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+    ++m_uringStats.enterCalls;
+    if (res == -1 && errno != EINTR) {
+        checkError(res);
+    }
+}
+
+bool UringLoop::deferred(std::uint64_t userData) const noexcept {
+    return std::any_of(m_deferred.begin(), m_deferred.end(),
+                       [userData](auto const &entry) { return entry.first == userData; });
+}
+
+/**
+ * @return 取消请求的结果
+ */
+int UringLoop::waitCancel(std::uint64_t tag) {
+    while (true) {
+        defer();
+        auto it = std::find_if(m_deferred.begin(), m_deferred.end(),
+                               [tag](auto const &entry) { return entry.first == tag; });
+        if (it != m_deferred.end()) {
+            int res = it->second;
+            m_deferred.erase(it);
+            return res;
+        }
+        enter();
+    }
+}
+
+void UringLoop::waitFor(std::uint64_t slot) {
+    while (true) {
+        defer();
+        if (deferred(slot)) {
+            return;
+        }
+        enter();
+    }
+}
+
+/**
+ * 取消一个仍然挂起的请求, 等待者保持挂起
+ * @return 请求还没有进入内核, 已经直接撤销, 调用者负责恢复协程
+ */
+bool UringLoop::requestCancel(UringOpAwaiter &awaiter) {
+    if (awaiter.m_queued) {
+        std::erase(m_backlog, &awaiter);
+        awaiter.m_queued = false;
+        release();
+        return true;
+    }
+    awaiter.m_cancelled = true;
+    pushCancel(awaiter);
+    return false;
+}
+
+/**
+ * 提交 IORING_OP_ASYNC_CANCEL 并立即 io_uring_enter, 提交队列满时先把已有的请求交给内核;
+ * 完成队列溢出导致内核拒绝提交时, 先把完成事件取出暂存, 这里不能恢复任何协程
+ * 链接了 poll 的请求先取消 poll, 还没有开始的读写随之以 -ECANCELED 结束
+ * @return 取消请求自己的 user_data
+ */
+std::uint64_t UringLoop::pushCancel(UringOpAwaiter &awaiter) {
+    unsigned needed = awaiter.m_linked ? 2 : 1;
+    while (sqSpace() < needed) {
+        flush();
+        if (sqSpace() < needed) {
+            defer();
+        }
+    }
+    std::uint64_t tag = 0;
+    for (std::uint64_t target: {kPollTag | awaiter.m_slot, awaiter.m_slot}) {
+        if (target != awaiter.m_slot && !awaiter.m_linked) {
+            continue;
+        }
+        auto *sqe = nextSqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = target;
+        tag = kCancelTag | (m_cancelSeq++ & ~(kCancelTag | kPollTag));
+        sqe->user_data = tag;
+        commitSqe();
+    }
+    flush();
+    return tag;
+}
+
+void UringOpAwaiter::onCancel(void *context) {
+    auto &awaiter = *static_cast<UringOpAwaiter *>(context);
+    if (awaiter.m_loop.requestCancel(awaiter)) {
+        awaiter.m_result = -ECANCELED;
+        FrameArena::resume(std::exchange(awaiter.m_coroutine, nullptr));
+    }
+}
+
+/**
+ * 一次 io_uring_enter 提交所有积攒的请求
+ * 完成队列暂时溢出 (EBUSY) 时留到下一轮, 先收割再提交
+ */
+void UringLoop::flush() {
+    while (m_toSubmit) {
+        int res = syscall(__NR_io_uring_enter, m_ring, m_toSubmit, 0, 0, nullptr, 0);
+        ++m_uringStats.enterCalls;
+        if (res == -1) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EBUSY) return;
+            checkError(res);
+        }
+        if (res == 0) return;
+        m_toSubmit -= res;
+        m_uringStats.submitted += res;
+    }
+}
+
+/**
+ * 批量收割完成队列, 完成队列的头指针只有本线程写
+ * 每取走一项就先推进头指针, 恢复的协程可能会继续提交新的请求
+ */
+std::size_t UringLoop::reap() {
+    std::size_t count = 0;
+    while (true) {
+        /* 恢复的协程可能又暂存了新的完成事件, 每次都先处理暂存的 */
+        if (!m_deferred.empty()) {
+            auto [slot, res] = m_deferred.back();
+            m_deferred.pop_back();
+            if (!(slot & (kCancelTag | kPollTag)) && complete(slot, res)) {
+                ++count;
+            }
+            continue;
+        }
+        unsigned head = *m_cqHead;
+        if (head == std::atomic_ref(*m_cqTail).load(std::memory_order_acquire)) {
+            break;
+        }
+        auto &cqe = m_cqes[head & m_cqMask];
+        std::uint64_t slot = cqe.user_data;
+        int res = cqe.res;
+        std::atomic_ref(*m_cqHead).store(++head, std::memory_order_release);
+        if (slot & (kCancelTag | kPollTag)) continue;
+        if (complete(slot, res)) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+/**
+ * 取出完成队列中的所有事件暂存起来, 留给下一次 reap
+ * 完成队列因此变空, epoll 不会再为它们唤醒, 排一个空协程让下一轮循环不阻塞
+ */
+void UringLoop::defer() {
+    unsigned head = *m_cqHead;
+    if (head == std::atomic_ref(*m_cqTail).load(std::memory_order_acquire)) {
+        return;
+    }
+    do {
+        auto &cqe = m_cqes[head & m_cqMask];
+        if (!(cqe.user_data & kPollTag)) {
+            m_deferred.emplace_back(cqe.user_data, cqe.res);
+        }
+        std::atomic_ref(*m_cqHead).store(++head, std::memory_order_release);
+    } while (head != std::atomic_ref(*m_cqTail).load(std::memory_order_acquire));
+    schedule(std::noop_coroutine());
+}
+
+/**
+ * 释放槽位并恢复等待者, 等待者已经销毁时只释放槽位
+ * 读写以 -EAGAIN 完成说明内核遵从 O_NONBLOCK, 之后的读写都先链接 poll
+ */
+bool UringLoop::complete(std::uint64_t slot, int res) {
+    ++m_uringStats.completions;
+    auto *awaiter = std::exchange(m_slots[slot], nullptr);
+    m_freeSlots.push_back(slot);
+    release();
+    if (!awaiter) {
+        return false;
+    }
+    if (res == -EAGAIN && !awaiter->m_linked) [[unlikely]] {
+        m_pollFirst = true;
+    }
+    awaiter->m_result = awaiter->m_cancelled ? -ECANCELED : res;
+    FrameArena::resume(std::exchange(awaiter->m_coroutine, nullptr));
+    return true;
+}
+
+bool UringLoop::run(std::optional<std::chrono::nanoseconds> timeout) {
+    if (supported()) {
+        std::size_t n = 0;
+        for (; n < m_backlog.size(); ++n) {
+            auto *awaiter = m_backlog[n];
+            awaiter->m_queued = false;
+            if (!pushSqe(*awaiter)) {
+                awaiter->m_queued = true;
+                break;
+            }
+        }
+        m_backlog.erase(m_backlog.begin(), m_backlog.begin() + n);
+        flush();
+        /**
+         * 提交时就已完成的请求直接收割, 不必等 epoll 通知
+         * 恢复的协程可能注册了新的定时器或请求, 本轮的超时已经过时, 只轮询不阻塞
+         */
+        if (reap()) {
+            timeout = std::chrono::nanoseconds::zero();
+        }
+    }
+    return EpollLoop::run(timeout);
+}
+
+/**
+ * io_uring 的返回值转换为与系统调用一致的错误处理
+ */
+inline std::size_t checkUringResult(int res) {
+    if (res < 0) [[unlikely]] {
+        errno = -res;
+        res = -1;
+    }
+    return checkError(res);
+}
+
+inline Task<size_t> read_file(UringLoop& loop, AsyncFile& file,
+                              std::span<char> buffer) {
+    if (!loop.supported()) {
+        co_return co_await read_file(static_cast<EpollLoop &>(loop), file, buffer);
+    }
+    /* 内核遵从 O_NONBLOCK 时第一次会以 EAGAIN 完成, 之后的请求链接了 poll, 就绪后才读 */
+    while (true) {
+        int res = co_await UringOpAwaiter(loop, IORING_OP_READ, file.fileNo(),
+                                          buffer.data(), buffer.size());
+        if (res != -EAGAIN) co_return checkUringResult(res);
+    }
+}
+
+inline Task<size_t> write_file(UringLoop& loop, AsyncFile& file,
+                               std::span<char const> buffer) {
+    if (!loop.supported()) {
+        co_return co_await write_file(static_cast<EpollLoop &>(loop), file, buffer);
+    }
+    while (true) {
+        int res = co_await UringOpAwaiter(loop, IORING_OP_WRITE, file.fileNo(),
+                                          buffer.data(), buffer.size());
+        if (res != -EAGAIN) co_return checkUringResult(res);
+    }
+}
+/**
+ * io_uring 的返回值转换为 Expected, 不抛出异常
+ */
+inline Expected<size_t> expectUringResult(int res) noexcept {
+    if (res < 0) [[unlikely]] {
+        return std::error_code(-res, std::system_category());
+    }
+    return static_cast<size_t>(res);
+}
+
+inline Task<Expected<size_t>> try_read_file(UringLoop& loop, AsyncFile& file,
+                                            std::span<char> buffer) {
+    if (!loop.supported()) {
+        co_return co_await try_read_file(static_cast<EpollLoop &>(loop), file, buffer);
+    }
+    while (true) {
+        int res = co_await UringOpAwaiter(loop, IORING_OP_READ, file.fileNo(),
+                                          buffer.data(), buffer.size());
+        if (res != -EAGAIN) co_return expectUringResult(res);
+    }
+}
+
+inline Task<Expected<size_t>> try_write_file(UringLoop& loop, AsyncFile& file,
+                                             std::span<char const> buffer) {
+    if (!loop.supported()) {
+        co_return co_await try_write_file(static_cast<EpollLoop &>(loop), file, buffer);
+    }
+    while (true) {
+        int res = co_await UringOpAwaiter(loop, IORING_OP_WRITE, file.fileNo(),
+                                          buffer.data(), buffer.size());
+        if (res != -EAGAIN) co_return expectUringResult(res);
+    }
+}
+}
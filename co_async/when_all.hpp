@@ -24,17 +24,23 @@ namespace co_async {
             return false;
         }
 
+        /* 辅助协程继承调用者的 CancelToken, 取消能传到每一个参数 */
+        template <class P>
         std::coroutine_handle<>
-        await_suspend(std::coroutine_handle<> coroutine) const {
+        await_suspend(std::coroutine_handle<P> coroutine) {
+            mArena.save();
             if (mTasks.empty())
                 return coroutine;
             mControl.mPrevious = coroutine;
+            for (auto const &t: mTasks)
+                t.mCoroutine.promise().mCancelToken = cancelTokenOf(coroutine);
             for (auto const &t: mTasks.subspan(0, mTasks.size() - 1))
                 t.mCoroutine.resume();
             return mTasks.back().mCoroutine;
         }
 
         void await_resume() const {
+            mArena.restore();
             if (mControl.mException) [[unlikely]] {
                 std::rethrow_exception(mControl.mException);
             }
@@ -42,6 +48,7 @@ namespace co_async {
 
         WhenAllCtlBlock &mControl;
         std::span<ReturnPreviousTask const> mTasks;
+        ArenaResume mArena;
     };
 
     template <class T>
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include "concepts.hpp"
+#include "non_void_helper.hpp"
+#include "return_previous.hpp"
+#include "timer_loop.hpp"
+
+namespace co_async {
+
+    /**
+     * 只保存句柄的 ReturnPreviousTask, 由 TimeoutAwaiter 决定何时销毁
+     */
+    struct TimeoutHelperTask {
+        using promise_type = ReturnPreviousPromise;
+
+        TimeoutHelperTask(std::coroutine_handle<promise_type> coroutine) noexcept
+                : mCoroutine(coroutine) {}
+
+        std::coroutine_handle<promise_type> mCoroutine;
+    };
+
+    template <class T>
+    TimeoutHelperTask timeoutHelper(auto &awaitable, std::optional<T> &result,
+                                    std::exception_ptr &exception,
+                                    std::coroutine_handle<> &previous) {
+        try {
+            result.emplace((co_await awaitable, NonVoidHelper<>()));
+        } catch (...) {
+            exception = std::current_exception();
+        }
+        co_return previous;
+    }
+
+    /**
+     * 让一个操作与一个定时器竞争, 定时器节点嵌入在等待者中,
+     * 唯一的分配是等待操作的辅助协程帧 (when_any 需要自身、每个参数一个辅助协程以及 sleep_for 的帧)
+     * 操作先完成时取消定时器; 定时器先到期时通过辅助协程的 CancelToken 取消操作,
+     * 等辅助协程结束之后才恢复调用者, 不会销毁还挂起着的辅助协程
+     * (操作可能已经把协程交给了循环, 例如 yield, 销毁之后循环会恢复一个不存在的协程)
+     * 调用者的 CancelToken 被取消时同样传给操作
+     */
+    template <class TimerLoopType, class A>
+    struct TimeoutAwaiter {
+        using ValueType = std::remove_cvref_t<typename AwaitableTraits<std::remove_reference_t<A>>::NonVoidRetType>;
+
+        TimeoutAwaiter(TimerLoopType &loop, A &&awaitable,
+                       typename TimerLoopType::ClockType::time_point expireTime)
+                : mLoop(loop), mAwaitable(std::forward<A>(awaitable)) {
+            mNode.m_expireTime = expireTime;
+            mNode.m_callback = &TimeoutAwaiter::onTimer;
+            mNode.mAwaiter = this;
+        }
+
+        TimeoutAwaiter(TimeoutAwaiter &&) = delete;
+
+        /* 只有调用者在等待期间被销毁时辅助协程才还没有结束 */
+        ~TimeoutAwaiter() {
+            if (mHelper) {
+                mHelper.destroy();
+            }
+        }
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        template <class P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> coroutine) {
+            mArena.save();
+            mPrevious = coroutine;
+            mHelper = timeoutHelper(mAwaitable, mResult, mException, mPrevious).mCoroutine;
+            mHelper.promise().mCancelToken = mCancel.token();
+            CancelToken token = cancelTokenOf(coroutine);
+            if (token.cancelled()) [[unlikely]] {
+                /* 还没有等待者, 只是标记, 操作挂起之前就会看到 */
+                mCancel.cancel();
+                mOuterCancelled = true;
+                return mHelper;
+            }
+            mOuterNode.link(token.state(), &TimeoutAwaiter::onOuterCancel, this);
+            mLoop.addTimer(mNode);
+            return mHelper;
+        }
+
+        /**
+         * @return 超时返回空; 定时器到期时操作已经完成则仍然返回它的结果
+         * 操作抛出的异常在这里重新抛出, 超时引起的 operation_canceled 除外
+         */
+        std::optional<ValueType> await_resume() {
+            mArena.restore();
+            mOuterNode.unlink();
+            mLoop.cancelTimer(mNode);
+            mHelper.destroy();
+            mHelper = nullptr;
+            bool timedOut = mTimedOut && !mOuterCancelled;
+            if (mException) [[unlikely]] {
+                if (timedOut) {
+                    try {
+                        std::rethrow_exception(mException);
+                    } catch (std::system_error const &e) {
+                        if (e.code() != std::errc::operation_canceled) {
+                            throw;
+                        }
+                    }
+                    return std::nullopt;
+                }
+                std::rethrow_exception(mException);
+            }
+            if constexpr (requires { mResult->error() == std::errc::operation_canceled; }) {
+                /* try_ 版本以错误码报告取消 */
+                if (timedOut && mResult->error() == std::errc::operation_canceled) {
+                    return std::nullopt;
+                }
+            }
+            return std::move(mResult);
+        }
+
+    private:
+        struct Node : TimerLoopType::TimerNode {
+            TimeoutAwaiter *mAwaiter;
+        };
+
+        static void onTimer(typename TimerLoopType::TimerNode &node) {
+            auto &self = *static_cast<Node &>(node).mAwaiter;
+            self.mTimedOut = true;
+            self.mCancel.cancel();
+        }
+
+        static void onOuterCancel(void *context) {
+            auto &self = *static_cast<TimeoutAwaiter *>(context);
+            self.mOuterCancelled = true;
+            self.mCancel.cancel();
+        }
+
+        TimerLoopType &mLoop;
+        A mAwaitable;
+        Node mNode;
+        std::coroutine_handle<ReturnPreviousPromise> mHelper;
+        std::coroutine_handle<> mPrevious;
+        std::optional<ValueType> mResult;
+        std::exception_ptr mException;
+        CancelSource mCancel;
+        CancelNode mOuterNode;
+        ArenaResume mArena;
+        bool mTimedOut = false;
+        bool mOuterCancelled = false;
+    };
+
+    /**
+     * 在 duration 内等待 awaitable 完成, 返回 std::optional, 超时返回空
+     * 等价于 when_any(awaitable, sleep_for(loop, duration)), 但只分配一个协程帧
+     *
+     *     auto line = co_await with_timeout(loop, read_string(loop, file), 1s);
+     *
+     * 右值的 awaitable 被移动到等待者中保存, 左值则保存引用
+     */
+    template <class Loop, Awaitable A, class Rep, class Period>
+    auto with_timeout(Loop &loop, A &&awaitable, std::chrono::duration<Rep, Period> duration) {
+        using TimerLoopType = typename Loop::TimerLoopType;
+        using ClockType = typename TimerLoopType::ClockType;
+        return TimeoutAwaiter<TimerLoopType, A>(
+                loop, std::forward<A>(awaitable),
+                ClockType::now() + std::chrono::duration_cast<typename ClockType::duration>(duration));
+    }
+
+    template <class Loop, Awaitable A, class Clock, class Duration>
+    auto with_deadline(Loop &loop, A &&awaitable, std::chrono::time_point<Clock, Duration> expireTime) {
+        using TimerLoopType = typename Loop::TimerLoopType;
+        using ClockType = typename TimerLoopType::ClockType;
+        return TimeoutAwaiter<TimerLoopType, A>(
+                loop, std::forward<A>(awaitable),
+                std::chrono::time_point_cast<typename ClockType::duration>(expireTime));
+    }
+
+} // namespace co_async
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace co_async {
+
+    /**
+     * Chase-Lev 工作窃取双端队列
+     * 只有拥有者线程可以 push/pop (在底部, 后进先出), 其他线程通过 steal 从顶部取走最早的元素
+     * 内存序参照 Lê 等人 "Correct and Efficient Work-Stealing for Weak Memory Models"
+     * 扩容后的旧缓冲区可能仍在被窃取者读取, 保留到队列析构时才释放
+     */
+    template <class T>
+    struct WorkStealingDeque {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        explicit WorkStealingDeque(std::size_t capacity = 64) {
+            std::size_t size = 1;
+            while (size < capacity) size <<= 1;
+            m_buffers.push_back(std::make_unique<Buffer>(size));
+            m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+        }
+
+        WorkStealingDeque(WorkStealingDeque &&) = delete;
+
+        /**
+         * 只能在拥有者线程调用
+         */
+        void push(T value) {
+            std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+            std::int64_t top = m_top.load(std::memory_order_acquire);
+            Buffer *buffer = m_buffer.load(std::memory_order_relaxed);
+            if (bottom - top >= static_cast<std::int64_t>(buffer->m_mask)) {
+                buffer = grow(buffer, top, bottom);
+            }
+            buffer->put(bottom, value);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        /**
+         * 只能在拥有者线程调用
+         */
+        std::optional<T> pop() {
+            std::int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+            Buffer *buffer = m_buffer.load(std::memory_order_relaxed);
+            m_bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t top = m_top.load(std::memory_order_relaxed);
+            if (top > bottom) {
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                return std::nullopt;
+            }
+            T value = buffer->get(bottom);
+            if (top == bottom) {
+                /* 只剩最后一个元素, 与窃取者竞争 */
+                bool won = m_top.compare_exchange_strong(top, top + 1,
+                                                         std::memory_order_seq_cst,
+                                                         std::memory_order_relaxed);
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                if (!won) return std::nullopt;
+            }
+            return value;
+        }
+
+        /**
+         * 可以在任意线程调用, 队列为空或者竞争失败时返回空
+         */
+        std::optional<T> steal() {
+            std::int64_t top = m_top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t bottom = m_bottom.load(std::memory_order_acquire);
+            if (top >= bottom) {
+                return std::nullopt;
+            }
+            T value = m_buffer.load(std::memory_order_acquire)->get(top);
+            if (!m_top.compare_exchange_strong(top, top + 1,
+                                               std::memory_order_seq_cst,
+                                               std::memory_order_relaxed)) {
+                return std::nullopt;
+            }
+            return value;
+        }
+
+        /**
+         * 可以在任意线程调用, 结果只是一个瞬间的近似值
+         */
+        bool empty() const noexcept {
+            std::int64_t top = m_top.load(std::memory_order_acquire);
+            std::int64_t bottom = m_bottom.load(std::memory_order_acquire);
+            return top >= bottom;
+        }
+
+    private:
+        struct Buffer {
+            explicit Buffer(std::size_t capacity)
+                    : m_mask(capacity - 1), m_slots(new std::atomic<T>[capacity]) {}
+
+            T get(std::int64_t index) const noexcept {
+                return m_slots[index & m_mask].load(std::memory_order_relaxed);
+            }
+
+            void put(std::int64_t index, T value) noexcept {
+                m_slots[index & m_mask].store(value, std::memory_order_relaxed);
+            }
+
+            std::size_t m_mask;
+            std::unique_ptr<std::atomic<T>[]> m_slots;
+        };
+
+        Buffer *grow(Buffer *buffer, std::int64_t top, std::int64_t bottom) {
+            m_buffers.push_back(std::make_unique<Buffer>((buffer->m_mask + 1) * 2));
+            Buffer *bigger = m_buffers.back().get();
+            for (std::int64_t i = top; i < bottom; ++i) {
+                bigger->put(i, buffer->get(i));
+            }
+            m_buffer.store(bigger, std::memory_order_release);
+            return bigger;
+        }
+
+        alignas(64) std::atomic<std::int64_t> m_top{0};
+        alignas(64) std::atomic<std::int64_t> m_bottom{0};
+        std::atomic<Buffer *> m_buffer;
+        /* 拥有者线程独占, 包括当前缓冲区和所有扩容前的旧缓冲区 */
+        std::vector<std::unique_ptr<Buffer>> m_buffers;
+    };
+
+} // namespace co_async
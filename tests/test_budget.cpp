@@ -0,0 +1,93 @@
+#include "co_async/debug.hpp"
+#include "co_async/async_loop.hpp"
+#include "check.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * 每轮最多从就绪队列恢复 budget 个协程: 反复 yield 的协程按先进先出轮流运行, 每轮不超过 budget 个;
+ * 就绪队列永远不空时, 每轮仍然会查询 epoll, 已经可读的 fd 在下一轮就能恢复它的等待者
+ */
+
+using namespace co_async;
+
+static std::vector<int> order;
+
+static Task<> yielder(AsyncLoop &loop, int id, int times) {
+    for (int i = 0; i < times; ++i) {
+        order.push_back(id);
+        co_await yield(loop);
+    }
+}
+
+static Task<> spinner(AsyncLoop &loop, bool &stop) {
+    while (!stop) {
+        co_await yield(loop);
+    }
+}
+
+static Task<> reader(AsyncLoop &loop, AsyncFile &file, bool &stop) {
+    char buffer[16];
+    CHECK(co_await read_file(loop, file, buffer) == 4);
+    stop = true;
+}
+
+static void checkFifo() {
+    static constexpr int kTasks = 5;
+    static constexpr int kTimes = 10;
+    static constexpr std::size_t kBudget = 3;
+    AsyncLoop loop;
+    loop.setBudget(kBudget);
+    order.clear();
+    std::vector<Task<>> tasks;
+    for (int id = 0; id < kTasks; ++id) {
+        tasks.push_back(yielder(loop, id, kTimes));
+        spawn_task(tasks.back());
+    }
+    while (true) {
+        std::size_t before = order.size();
+        if (!loop.run()) {
+            break;
+        }
+        CHECK(order.size() - before <= kBudget);
+    }
+    CHECK(order.size() == kTasks * kTimes);
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        CHECK(order[i] == (int) (i % kTasks));
+    }
+}
+
+static void checkPollWhenExhausted() {
+    AsyncLoop loop;
+    loop.setBudget(1);
+    int fds[2];
+    checkError(pipe2(fds, O_NONBLOCK | O_CLOEXEC));
+    AsyncFile readEnd(fds[0]);
+    AsyncFile writeEnd(fds[1]);
+    bool stop = false;
+    auto waiting = reader(loop, readEnd, stop);
+    spawn_task(waiting);
+    std::vector<Task<>> spinners;
+    for (int i = 0; i < 2; ++i) {
+        spinners.push_back(spinner(loop, stop));
+        spawn_task(spinners.back());
+    }
+    CHECK(write(writeEnd.fileNo(), "data", 4) == 4);
+    std::size_t waitCalls = loop.stats().waitCalls;
+    /* 两个 spinner 轮流 yield, 每轮只恢复一个, 就绪队列不会变空 */
+    for (int tick = 0; tick < 2 && !stop; ++tick) {
+        loop.run();
+    }
+    CHECK(stop);
+    CHECK(loop.stats().waitCalls > waitCalls);
+    while (loop.run()) {
+    }
+}
+
+int main() {
+    checkFifo();
+    checkPollWhenExhausted();
+    return 0;
+}
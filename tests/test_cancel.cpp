@@ -0,0 +1,100 @@
+#include "co_async/debug.hpp"
+#include "co_async/async_loop.hpp"
+#include "check.hpp"
+
+#include <fcntl.h>
+#include <cstring>
+#include <optional>
+#include <unistd.h>
+
+/**
+ * 取消挂起在定时器和 epoll 上的等待: cancel 本身不恢复等待者, 它们在循环的下一轮中恢复,
+ * 普通版本抛出 operation_canceled, try_ 版本返回错误码;
+ * 取消之后、恢复之前被销毁的等待者不会再被恢复
+ */
+
+using namespace co_async;
+using namespace std::chrono_literals;
+
+static int resumed = 0;
+
+static Task<> sleeper(AsyncLoop &loop) {
+    try {
+        co_await sleep_for(loop, 100s);
+    } catch (std::system_error const &e) {
+        CHECK(e.code() == std::errc::operation_canceled);
+        ++resumed;
+    }
+}
+
+static Task<> reader(AsyncLoop &loop, AsyncFile &file) {
+    char buffer[16];
+    try {
+        co_await read_file(loop, file, buffer);
+    } catch (std::system_error const &e) {
+        CHECK(e.code() == std::errc::operation_canceled);
+        ++resumed;
+    }
+}
+
+static Task<> tryReader(AsyncLoop &loop, AsyncFile &file) {
+    char buffer[16];
+    auto n = co_await try_read_file(loop, file, buffer);
+    CHECK(n.error() == std::errc::operation_canceled);
+    ++resumed;
+}
+
+static Task<> run(AsyncLoop &loop, AsyncFile &readEnd, AsyncFile &writeEnd) {
+    CancelSource source;
+    auto start = std::chrono::steady_clock::now();
+    auto a = with_cancel(sleeper(loop), source.token());
+    auto b = with_cancel(reader(loop, readEnd), source.token());
+    spawn_task(a);
+    spawn_task(b);
+    co_await sleep_for(loop, 1ms);
+    source.cancel();
+    /* 等待者还没有恢复, 调用者不会被重入 */
+    CHECK(resumed == 0);
+    co_await yield(loop);
+    CHECK(resumed == 2);
+    CHECK(std::chrono::steady_clock::now() - start < 1s);
+
+    source.reset();
+    auto c = with_cancel(tryReader(loop, readEnd), source.token());
+    spawn_task(c);
+    co_await sleep_for(loop, 1ms);
+    source.cancel();
+    co_await yield(loop);
+    CHECK(resumed == 3);
+
+    /* 取消后 fd 仍然可以正常等待 */
+    CHECK(write(writeEnd.fileNo(), "data", 4) == 4);
+    char buffer[16]{};
+    CHECK(co_await read_file(loop, readEnd, buffer) == 4);
+    CHECK(std::memcmp(buffer, "data", 4) == 0);
+
+    /* 取消之后立即销毁等待者, 回调不会再访问它们 */
+    source.reset();
+    std::optional<Task<>> doomed[] = {with_cancel(sleeper(loop), source.token()),
+                                      with_cancel(reader(loop, readEnd), source.token())};
+    for (auto &task: doomed) {
+        spawn_task(*task);
+    }
+    co_await yield(loop);
+    source.cancel();
+    for (auto &task: doomed) {
+        task.reset();
+    }
+    co_await yield(loop);
+    CHECK(resumed == 3);
+}
+
+int main() {
+    AsyncLoop loop;
+    int fds[2];
+    checkError(pipe2(fds, O_NONBLOCK | O_CLOEXEC));
+    AsyncFile readEnd(fds[0]);
+    AsyncFile writeEnd(fds[1]);
+    run_task(loop, run(loop, readEnd, writeEnd));
+    return 0;
+}
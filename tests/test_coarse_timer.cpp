@@ -0,0 +1,37 @@
+#include "co_async/debug.hpp"
+#include "co_async/async_loop.hpp"
+#include "check.hpp"
+
+#include <chrono>
+
+/**
+ * CoarseSteadyClock 的读数最多落后一个时钟节拍, 循环等待的超时要多等一个节拍:
+ * 否则醒来时读到的时间还没到, 同一个定时器要反复等待好几次
+ * timerfd 的绝对到期时间也不能从落后的粗略读数算出, 否则写入时就已经过去, 循环空转
+ */
+
+using namespace co_async;
+using namespace std::chrono_literals;
+
+using CoarseAsyncLoop = BasicAsyncLoop<CoarseTimerLoop>;
+
+static constexpr int kSleeps = 100;
+
+static Task<> sleeper(CoarseAsyncLoop &loop) {
+    for (int i = 0; i < kSleeps; ++i) {
+        auto start = CoarseSteadyClock::now();
+        co_await sleep_for(loop, 1ms);
+        CHECK(CoarseSteadyClock::now() - start >= 1ms);
+    }
+}
+
+int main() {
+    for (bool timerFd: {false, true}) {
+        CoarseAsyncLoop loop;
+        loop.setTimerFd(timerFd);
+        run_task(loop, sleeper(loop));
+        /* 留一点余量给被信号之类打断的等待 */
+        CHECK(loop.stats().waitCalls <= kSleeps + kSleeps / 10);
+    }
+    return 0;
+}
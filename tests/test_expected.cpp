@@ -0,0 +1,117 @@
+#include "co_async/debug.hpp"
+#include "co_async/async_loop.hpp"
+#include "check.hpp"
+
+#include <arpa/inet.h>
+#include <csignal>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * Expected 与 expectError 的基本行为; try_ 版本的 I/O 在连接建立、对端关闭写端和重置时
+ * 分别返回数据、0 字节(EOF) 和 connection_reset, 不抛出异常
+ * 分别在 epoll 和 io_uring 上运行
+ */
+
+using namespace co_async;
+
+static void checkExpected() {
+    Expected<int> value(42);
+    CHECK(value && value.hasValue() && *value == 42 && !value.error());
+    Expected<int> error(std::make_error_code(std::errc::connection_reset));
+    CHECK(!error && error.error() == std::errc::connection_reset);
+    bool thrown = false;
+    try {
+        (void) error.value();
+    } catch (std::system_error const &e) {
+        thrown = e.code() == std::errc::connection_reset;
+    }
+    CHECK(thrown);
+
+    Expected<void> ok;
+    CHECK(ok && !ok.error());
+    Expected<void> failed(std::make_error_code(std::errc::broken_pipe));
+    CHECK(!failed && failed.error() == std::errc::broken_pipe);
+
+    CHECK(*expectError(5) == 5);
+    errno = EBADF;
+    auto bad = expectError(-1);
+    CHECK(!bad && bad.error() == std::errc::bad_file_descriptor);
+}
+
+/* 协程体内漏出的 std::system_error 转换为错误码 */
+static Task<Expected<int>> leaks() {
+    errno = ENOENT;
+    co_return checkError(-1);
+}
+
+static AsyncFile tcpSocket() {
+    return AsyncFile(checkError(socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)));
+}
+
+template <class Loop>
+static Task<> run(Loop &loop, EpollLoop &io) {
+    auto leaked = co_await leaks();
+    CHECK(leaked.error() == std::errc::no_such_file_or_directory);
+
+    AsyncFile listener = tcpSocket();
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrLen = sizeof(addr);
+    checkError(bind(listener.fileNo(), (struct sockaddr *) &addr, addrLen));
+    checkError(listen(listener.fileNo(), 2));
+    checkError(getsockname(listener.fileNo(), (struct sockaddr *) &addr, &addrLen));
+
+    for (bool reset: {false, true}) {
+        AsyncFile client = tcpSocket();
+        auto connected = co_await try_connect(io, client, (struct sockaddr *) &addr, addrLen);
+        CHECK(connected);
+        auto accepted = co_await try_accept(io, listener);
+        CHECK(accepted);
+        AsyncFile server = std::move(*accepted);
+
+        std::span<char const> hello("hello", 5);
+        auto written = co_await try_write_file(loop, server, hello);
+        CHECK(written && *written == 5);
+        char buffer[16]{};
+        auto n = co_await try_read_file(loop, client, buffer);
+        CHECK(n && *n == 5 && std::memcmp(buffer, "hello", 5) == 0);
+
+        if (!reset) {
+            /* 对端关闭写端: 读到 0 字节 */
+            checkError(shutdown(server.fileNo(), SHUT_WR));
+            n = co_await try_read_file(loop, client, buffer);
+            CHECK(n && *n == 0);
+            continue;
+        }
+        /* SO_LINGER 为 0 时 close 发送 RST */
+        struct linger lin{1, 0};
+        checkError(setsockopt(server.fileNo(), SOL_SOCKET, SO_LINGER, &lin, sizeof(lin)));
+        server = AsyncFile();
+        n = co_await try_read_file(loop, client, buffer);
+        CHECK(!n && n.error() == std::errc::connection_reset);
+        written = co_await try_write_file(loop, client, hello);
+        CHECK(!written && written.error() == std::errc::broken_pipe);
+    }
+}
+
+int main() {
+    std::signal(SIGPIPE, SIG_IGN);
+    checkExpected();
+    {
+        AsyncLoop loop;
+        run_task(loop, run(loop, loop));
+    }
+    {
+        UringAsyncLoop loop;
+        auto &uring = static_cast<UringLoop &>(loop);
+        if (!uring.supported()) {
+            return 77;
+        }
+        run_task(loop, run(uring, uring));
+    }
+    return 0;
+}
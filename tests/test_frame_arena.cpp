@@ -0,0 +1,100 @@
+#include "co_async/debug.hpp"
+#include "co_async/async_loop.hpp"
+#include "co_async/when_all.hpp"
+#include "check.hpp"
+
+/**
+ * FrameArena 中长期运行的任务反复等待子任务时, 释放的帧被同级的新帧复用, 内存不随次数增长;
+ * 所有帧释放后区域整体回收; FrameArena 先于任务析构时, 最后一个帧释放时归还内存
+ * 定时器恢复之后创建的子协程仍在区域中, 任务挂起回到循环后不再有当前区域;
+ * 只提供非成员 operator co_await 的类型也可以等待
+ * 关闭 CO_ASYNC_FRAME_POOL 时编译为 test_frame_arena_malloc, 区域的行为不变
+ */
+
+using namespace co_async;
+using namespace std::chrono_literals;
+
+static constexpr int kChildren = 20000;
+
+static Task<int> child(AsyncLoop &loop, int x) {
+    co_await yield(loop);
+    co_return x;
+}
+
+struct YieldTo {
+    AsyncLoop &loop;
+};
+
+static YieldAwaiter operator co_await(YieldTo to) {
+    return yield(to.loop);
+}
+
+static Task<long> handler(AsyncLoop &loop) {
+    long sum = 0;
+    for (int i = 0; i < kChildren; ++i) {
+        sum += co_await child(loop, i);
+    }
+    auto [a, b] = co_await when_all(child(loop, 1), child(loop, 2));
+    co_return sum + a + b;
+}
+
+static Task<int> sleeper(AsyncLoop &loop) {
+    co_await sleep_for(loop, 1ms);
+    co_await YieldTo{loop};
+    int x = co_await child(loop, 1);
+    co_await sleep_for(loop, 1ms);
+    co_return x + co_await child(loop, 2);
+}
+
+int main() {
+    AsyncLoop loop;
+    {
+        FrameArena arena(4096);
+        auto poolBefore = FramePool::stats().allocations;
+        auto task = arena.bind([&] { return handler(loop); });
+        CHECK(run_task(loop, task) == (long) kChildren * (kChildren - 1) / 2 + 3);
+        auto const &stats = arena.stats();
+        /* 每次只有顶层任务和一个子任务的帧同时存在 */
+        CHECK(stats.chunks == 1);
+        CHECK(stats.frames > kChildren);
+        CHECK(stats.reused + 8 >= stats.frames);
+        CHECK(arena.live() == 1);
+        CHECK(stats.rewinds == 0);
+        /* when_all 的辅助协程同样来自区域 */
+        CHECK(FramePool::stats().allocations == poolBefore);
+    }
+    {
+        FrameArena arena;
+        {
+            auto task = arena.bind([&] { return child(loop, 7); });
+            CHECK(run_task(loop, task) == 7);
+        }
+        CHECK(arena.live() == 0);
+        CHECK(arena.stats().rewinds == 1);
+        /* 回收之后再次使用, 不再申请新的块 */
+        auto task = arena.bind([&] { return child(loop, 8); });
+        CHECK(run_task(loop, task) == 8);
+        CHECK(arena.stats().chunks == 1);
+    }
+    {
+        FrameArena arena;
+        auto poolBefore = FramePool::stats().allocations;
+        auto task = arena.bind([&] { return sleeper(loop); });
+        spawn_task(task);
+        /* 任务挂起在定时器上, 循环中没有当前区域 */
+        CHECK(FrameArena::current() == nullptr);
+        while (loop.run());
+        CHECK(FrameArena::current() == nullptr);
+        CHECK(task.mCoroutine.promise().result() == 3);
+        /* sleeper、两个 sleep_for 和两个 child, 定时器恢复之后创建的也在区域中 */
+        CHECK(arena.stats().frames == 5);
+        CHECK(FramePool::stats().allocations == poolBefore);
+    }
+    {
+        auto *arena = new FrameArena;
+        auto task = arena->bind([&] { return child(loop, 9); });
+        delete arena;
+        CHECK(run_task(loop, task) == 9);
+    }
+    return 0;
+}
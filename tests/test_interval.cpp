@@ -0,0 +1,57 @@
+#include "co_async/debug.hpp"
+#include "co_async/timer_loop.hpp"
+#include "check.hpp"
+
+#include <chrono>
+#include <vector>
+
+/**
+ * Interval 按绝对时间点到期; 协程处理一次到期时卡住了 35ms (周期 10ms) 之后,
+ * Burst 立即补上错过的 20/30/40 并继续对齐到原来的节奏,
+ * Skip 只补上最早的那一次, 之后跳到晚于现在的下一个对齐时间点,
+ * Delay 同样只补一次, 之后从现在起重新计时
+ */
+
+using namespace co_async;
+using namespace std::chrono_literals;
+
+struct Tick {
+    std::chrono::milliseconds planned;
+    std::chrono::milliseconds now;
+
+    bool operator==(Tick const &) const = default;
+};
+
+static std::chrono::milliseconds ms(VirtualClock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch());
+}
+
+static Task<> ticks(VirtualTimerLoop &loop, MissedTick missedTick, std::vector<Tick> &result) {
+    Interval interval(loop, 10ms, missedTick);
+    for (int i = 0; i < 6; ++i) {
+        auto planned = co_await interval;
+        result.push_back({ms(planned), ms(VirtualClock::now())});
+        if (i == 0) {
+            /* 卡住, 错过 20、30 和 40 三次到期 */
+            VirtualClock::advance(35ms);
+        }
+    }
+}
+
+static std::vector<Tick> run(MissedTick missedTick) {
+    VirtualTimerLoop loop;
+    VirtualClock::reset();
+    std::vector<Tick> result;
+    run_task(loop, ticks(loop, missedTick, result));
+    return result;
+}
+
+int main() {
+    CHECK(run(MissedTick::Burst) ==
+          (std::vector<Tick>{{10ms, 10ms}, {20ms, 45ms}, {30ms, 45ms}, {40ms, 45ms}, {50ms, 50ms}, {60ms, 60ms}}));
+    CHECK(run(MissedTick::Skip) ==
+          (std::vector<Tick>{{10ms, 10ms}, {20ms, 45ms}, {50ms, 50ms}, {60ms, 60ms}, {70ms, 70ms}, {80ms, 80ms}}));
+    CHECK(run(MissedTick::Delay) ==
+          (std::vector<Tick>{{10ms, 10ms}, {20ms, 45ms}, {55ms, 55ms}, {65ms, 65ms}, {75ms, 75ms}, {85ms, 85ms}}));
+    return 0;
+}
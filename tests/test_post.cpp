@@ -0,0 +1,129 @@
+#include "co_async/debug.hpp"
+#include "co_async/epoll_loop.hpp"
+#include "co_async/mpsc_queue.hpp"
+#include "check.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <thread>
+#include <vector>
+
+/**
+ * 多个线程同时向一个 EpollLoop post, 每轮投递完之后队列都会被取空, 下一轮重新经历由空变为非空:
+ * 只有这一次投递写 eventfd, 任何一次唤醒丢失都会让循环永远等下去, 这里以超时判定失败
+ * 投递数远超环的容量, 同时检查退回链栈时每个生产者的投递仍然按顺序恢复
+ * 最后单独用容量很小的 MpscQueue 检查环和链栈交替使用时的顺序
+ */
+
+using namespace co_async;
+using namespace std::chrono_literals;
+
+static constexpr int kProducers = 8;
+static constexpr int kPosts = 3000;
+static constexpr int kRounds = 20;
+
+static int delivered = 0;
+static int lastSequence[kProducers];
+static bool ordered = true;
+
+/* 投递出去的协程: 恢复时记录自己是谁, 结束后自动释放 */
+struct Posted {
+    struct promise_type {
+        Posted get_return_object() {
+            return {std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() noexcept {}
+    };
+
+    std::coroutine_handle<promise_type> mCoroutine;
+};
+
+static Posted record(int producer, int sequence) {
+    if (sequence <= lastSequence[producer]) {
+        ordered = false;
+    }
+    lastSequence[producer] = sequence;
+    ++delivered;
+    co_return;
+}
+
+static void checkLoop() {
+    EpollLoop loop;
+    /* 投递不会让循环保持运行 */
+    loop.retain();
+    for (int &sequence: lastSequence) {
+        sequence = -1;
+    }
+    int expected = 0;
+    for (int round = 0; round < kRounds; ++round) {
+        std::atomic<bool> start{false};
+        std::vector<std::thread> producers;
+        for (int p = 0; p < kProducers; ++p) {
+            producers.emplace_back([&loop, &start, p, round] {
+                while (!start.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                for (int i = 0; i < kPosts; ++i) {
+                    loop.post(record(p, round * kPosts + i).mCoroutine);
+                }
+            });
+        }
+        start.store(true, std::memory_order_release);
+        expected += kProducers * kPosts;
+        auto deadline = std::chrono::steady_clock::now() + 20s;
+        while (delivered < expected) {
+            loop.run(100ms);
+            CHECK(std::chrono::steady_clock::now() < deadline);
+        }
+        for (auto &producer: producers) {
+            producer.join();
+        }
+        CHECK(delivered == expected);
+        CHECK(ordered);
+    }
+    loop.release();
+}
+
+static void checkQueue() {
+    MpscQueue<int> queue(4);
+    std::vector<int> popped;
+    auto pop = [&] {
+        return queue.popAll([&](int value) {
+            popped.push_back(value);
+        });
+    };
+    CHECK(queue.push(0));
+    for (int i = 1; i < 10; ++i) {
+        /* 容量为 4, 之后的都压入链栈 */
+        CHECK(!queue.push(i));
+    }
+    CHECK(!pop());
+    CHECK(queue.empty());
+    /* 环取空之后重新先用环 */
+    for (int i = 10; i < 13; ++i) {
+        queue.push(i);
+    }
+    CHECK(!pop());
+    CHECK(popped.size() == 13);
+    for (int i = 0; i < 13; ++i) {
+        CHECK(popped[i] == i);
+    }
+}
+
+int main() {
+    checkQueue();
+    checkLoop();
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "co_async/rbtree.hpp"
+#include "check.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+/**
+ * 随机插入和删除(包括大量相等的键), 每一步之后检查红黑树的性质以及缓存的最小、最大节点
+ */
+
+using namespace co_async;
+
+struct Item : RbTree<Item>::RbNode {
+    int m_key = 0;
+    bool m_inTree = false;
+
+    friend bool operator<(Item const &lhs, Item const &rhs) noexcept {
+        return lhs.m_key < rhs.m_key;
+    }
+};
+
+static void checkBounds(RbTree<Item> &tree, std::vector<Item> &items) {
+    CHECK(tree.checkInvariants());
+    int minKey = 0, maxKey = 0;
+    bool any = false;
+    for (auto &item : items) {
+        if (item.m_inTree) {
+            minKey = any ? std::min(minKey, item.m_key) : item.m_key;
+            maxKey = any ? std::max(maxKey, item.m_key) : item.m_key;
+            any = true;
+        }
+    }
+    CHECK(tree.empty() == !any);
+    if (any) {
+        CHECK(tree.front().m_key == minKey);
+        CHECK(tree.back().m_key == maxKey);
+    }
+}
+
+int main() {
+    for (unsigned seed = 1; seed <= 4; ++seed) {
+        std::mt19937 rng(seed);
+        RbTree<Item> tree;
+        std::vector<Item> items(500);
+        for (int step = 0; step < 20000; ++step) {
+            auto &item = items[rng() % items.size()];
+            if (item.m_inTree) {
+                tree.erase(item);
+                item.m_inTree = false;
+            } else {
+                item.m_key = (int) (rng() % 200);
+                tree.insert(item);
+                item.m_inTree = true;
+            }
+            checkBounds(tree, items);
+            /* 偶尔像定时器到期那样连续弹出最小值 */
+            if (step % 1000 == 999) {
+                for (int i = 0; i < 50 && !tree.empty(); ++i) {
+                    auto &front = tree.front();
+                    tree.erase(front);
+                    front.m_inTree = false;
+                    checkBounds(tree, items);
+                }
+            }
+        }
+        for (auto &item : items) {
+            if (item.m_inTree) {
+                tree.erase(item);
+                item.m_inTree = false;
+                checkBounds(tree, items);
+            }
+        }
+        CHECK(tree.empty());
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+#include "co_async/debug.hpp"
+#include "co_async/runtime.hpp"
+#include "check.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <unistd.h>
+
+/**
+ * 开启工作窃取后, 任务在循环的某一轮中(例如定时器到期后) spawn 的新任务压入当前线程的队列,
+ * 当前线程不能在这一轮里无限期阻塞, 即使没有其他线程可以来窃取
+ */
+
+using namespace co_async;
+using namespace std::chrono_literals;
+
+static std::atomic<int> finished{0};
+
+static Task<> child(AsyncLoop &loop) {
+    co_await yield(loop);
+    ++finished;
+}
+
+static Task<> parent(Runtime &runtime, AsyncLoop &loop, int depth) {
+    co_await sleep_for(loop, 1ms);
+    runtime.spawn([](AsyncLoop &loop) { return child(loop); });
+    if (depth > 0) {
+        runtime.spawn([&runtime, depth](AsyncLoop &loop) { return parent(runtime, loop, depth - 1); });
+    }
+    ++finished;
+}
+
+static void runWith(std::size_t threads) {
+    finished = 0;
+    Runtime runtime(threads, false);
+    runtime.setStealing(true);
+    runtime.spawn([&runtime](AsyncLoop &loop) { return parent(runtime, loop, 9); });
+    runtime.run();
+    CHECK(finished == 20);
+}
+
+int main() {
+    /* 修复之前这里会永远阻塞在 epoll 中, 用 alarm 把挂起变成失败 */
+    alarm(10);
+    runWith(1);
+    runWith(2);
+    runWith(4);
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include "co_async/debug.hpp"
+#include "co_async/async_loop.hpp"
+#include "co_async/task_group.hpp"
+#include "check.hpp"
+
+#include <stdexcept>
+
+/**
+ * TaskGroup: 等待所有任务结束; 第一个异常取消其余任务并在 co_await 时重新抛出;
+ * 外层取消传到组内; 析构时销毁还没有结束的任务
+ */
+
+using namespace co_async;
+using namespace std::chrono_literals;
+
+static int finished = 0;
+static int cancelled = 0;
+static int destroyed = 0;
+
+struct Guard {
+    ~Guard() {
+        ++destroyed;
+    }
+};
+
+static Task<int> worker(AsyncLoop &loop, int i) {
+    co_await sleep_for(loop, std::chrono::microseconds(i % 50));
+    co_await yield(loop);
+    ++finished;
+    co_return i;
+}
+
+static Task<> failer(AsyncLoop &loop) {
+    co_await sleep_for(loop, 1ms);
+    throw std::runtime_error("boom");
+}
+
+static Task<> forever(AsyncLoop &loop) {
+    Guard guard;
+    try {
+        co_await sleep_for(loop, 100s);
+    } catch (std::system_error const &e) {
+        CHECK(e.code() == std::errc::operation_canceled);
+        ++cancelled;
+        throw;
+    }
+}
+
+static Task<> waitGroup(TaskGroup &group) {
+    co_await group;
+}
+
+static Task<> cancelLater(AsyncLoop &loop, CancelSource &source) {
+    co_await sleep_for(loop, 2ms);
+    source.cancel();
+}
+
+static Task<> run(AsyncLoop &loop) {
+    TaskGroup group;
+    for (int i = 0; i < 1000; ++i) {
+        group.spawn(worker(loop, i));
+    }
+    CHECK(group.size() == 1000);
+    co_await group;
+    CHECK(finished == 1000);
+    CHECK(group.empty());
+
+    /* 失败的任务取消其余任务, 异常在 co_await 时抛出 */
+    for (int i = 0; i < 10; ++i) {
+        group.spawn(forever(loop));
+    }
+    group.spawn(failer(loop));
+    bool caught = false;
+    try {
+        co_await group;
+    } catch (std::runtime_error const &) {
+        caught = true;
+    }
+    CHECK(caught);
+    CHECK(cancelled == 10);
+    CHECK(group.empty());
+
+    /* 之后可以继续使用 */
+    group.spawn(worker(loop, 0));
+    co_await group;
+    CHECK(finished == 1001);
+
+    /* 等待任务组的协程被取消时取消整个组 */
+    CancelSource source;
+    TaskGroup outer;
+    for (int i = 0; i < 5; ++i) {
+        outer.spawn(forever(loop));
+    }
+    auto waiter = with_cancel(waitGroup(outer), source.token());
+    auto stop = cancelLater(loop, source);
+    spawn_task(stop);
+    caught = false;
+    try {
+        co_await waiter;
+    } catch (std::system_error const &e) {
+        caught = e.code() == std::errc::operation_canceled;
+    }
+    CHECK(caught);
+    CHECK(cancelled == 15);
+    CHECK(outer.empty());
+
+    /* 析构时销毁还在运行的任务 */
+    destroyed = 0;
+    {
+        TaskGroup doomed;
+        for (int i = 0; i < 5; ++i) {
+            doomed.spawn(forever(loop));
+        }
+        CHECK(doomed.size() == 5);
+    }
+    CHECK(destroyed == 5);
+    CHECK(cancelled == 15);
+}
+
+int main() {
+    AsyncLoop loop;
+    run_task(loop, run(loop));
+    return 0;
+}
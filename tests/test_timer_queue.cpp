@@ -0,0 +1,243 @@
+#include "co_async/debug.hpp"
+#include "co_async/timer_loop.hpp"
+#include "check.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+/**
+ * 以 VirtualClock 驱动的定时器循环: 各种定时器队列的到期顺序和到期时间必须与 OrderedTimerQueue 一致
+ * 随机的到期时间覆盖时间轮各层的边界和超出最高层的范围, 还包括到期前取消、
+ * 在到期回调中取消尚未到期的定时器、以及插入已经过去的到期时间 (下一轮立即到期)
+ * 另外随机交替地插入、取消、改期和推进时间, 到期回调中还会重新插入自己,
+ * 检查 4 叉堆和配对堆在任意的增删和弹出序列下与红黑树的结果一致
+ * 到期时间都是整毫秒, 时间轮的取整不会改变结果; 同一时间点到期的定时器之间不比较顺序
+ */
+
+using namespace co_async;
+using namespace std::chrono_literals;
+
+static constexpr int kTimers = 3000;
+/* 开始时间不为 0, 留出插入过去时间点的余地 */
+static constexpr auto kStart = VirtualClock::time_point(std::chrono::hours(1));
+
+struct Plan {
+    std::chrono::milliseconds delay;
+    /* 在第一轮之前取消 */
+    bool cancelEarly;
+    /* 到期时取消下一个定时器 (如果它还没有到期) */
+    bool cancelNext;
+    /* 到期时插入一个 3ms 之前就应该到期的定时器 */
+    bool insertPast;
+};
+
+struct Fired {
+    std::int64_t time;
+    int id;
+
+    bool operator==(Fired const &) const = default;
+
+    bool operator<(Fired const &that) const {
+        return time != that.time ? time < that.time : id < that.id;
+    }
+};
+
+static std::vector<Plan> makePlan(std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    /* 时间轮每层 256 个槽, 刻度为 1ms */
+    static constexpr std::int64_t kBoundaries[] = {256, 65536, 16777216, 4294967296};
+    std::vector<Plan> plan;
+    for (int i = 0; i < kTimers; ++i) {
+        std::int64_t delay;
+        switch (rng() % 4) {
+        case 0:
+            delay = rng() % 1000;
+            break;
+        case 1: {
+            /* 某一层边界附近 */
+            std::int64_t boundary = kBoundaries[rng() % 4] * (1 + rng() % 3);
+            delay = boundary + (std::int64_t) (rng() % 5) - 2;
+            break;
+        }
+        case 2:
+            delay = std::int64_t(1) << (rng() % 34);
+            delay += rng() % (delay + 1);
+            break;
+        default:
+            delay = rng() % 100000;
+            break;
+        }
+        plan.push_back({std::chrono::milliseconds(delay), rng() % 7 == 0, rng() % 11 == 0, rng() % 13 == 0});
+    }
+    return plan;
+}
+
+template <template <class> class Queue>
+static std::vector<Fired> simulate(std::vector<Plan> const &plan) {
+    using Loop = BasicTimerLoop<Queue, VirtualClock>;
+
+    struct Node : Loop::TimerNode {
+        int mId;
+        Loop *mLoop;
+        std::vector<Plan> const *mPlan;
+        std::vector<Fired> *mFired;
+        Node *mNodes;
+    };
+
+    static constexpr auto onExpire = [](typename Loop::TimerNode &timer) {
+        auto &node = static_cast<Node &>(timer);
+        auto now = VirtualClock::now();
+        node.mFired->push_back({(now - kStart).count(), node.mId});
+        if (node.mId >= kTimers) {
+            return;
+        }
+        Plan const &plan = (*node.mPlan)[node.mId];
+        if (plan.cancelNext && node.mId + 1 < kTimers) {
+            Node &next = node.mNodes[node.mId + 1];
+            if (next.m_expireTime > now) {
+                node.mLoop->cancelTimer(next);
+            }
+        }
+        if (plan.insertPast) {
+            Node &past = node.mNodes[kTimers + node.mId];
+            past.m_expireTime = now - 3ms;
+            node.mLoop->addTimer(past);
+        }
+    };
+
+    VirtualClock::reset(kStart);
+    Loop loop;
+    std::vector<Fired> fired;
+    auto nodes = std::make_unique<Node[]>(kTimers * 2);
+    for (int i = 0; i < kTimers * 2; ++i) {
+        Node &node = nodes[i];
+        node.mId = i;
+        node.mLoop = &loop;
+        node.mPlan = &plan;
+        node.mFired = &fired;
+        node.mNodes = nodes.get();
+        node.m_callback = +onExpire;
+    }
+    for (int i = 0; i < kTimers; ++i) {
+        nodes[i].m_expireTime = kStart + plan[i].delay;
+        loop.addTimer(nodes[i]);
+    }
+    /* 已经过去的到期时间, 第一轮就到期 */
+    for (int i = 0; i < kTimers; i += 97) {
+        loop.cancelTimer(nodes[i]);
+        nodes[i].m_expireTime = kStart - 5ms;
+        loop.addTimer(nodes[i]);
+    }
+    for (int i = 0; i < kTimers; ++i) {
+        if (plan[i].cancelEarly) {
+            loop.cancelTimer(nodes[i]);
+        }
+    }
+    while (loop.run()) {
+    }
+    CHECK(!loop.hasEvent());
+    CHECK(std::is_sorted(fired.begin(), fired.end(), [](Fired const &a, Fired const &b) {
+        return a.time < b.time;
+    }));
+    std::sort(fired.begin(), fired.end());
+    return fired;
+}
+
+static constexpr int kChurnTimers = 500;
+static constexpr int kChurnSteps = 20000;
+
+template <template <class> class Queue>
+static std::vector<Fired> churn(std::uint32_t seed) {
+    using Loop = BasicTimerLoop<Queue, VirtualClock>;
+
+    struct Node : Loop::TimerNode {
+        int mId;
+        int mRearms = 0;
+        Loop *mLoop;
+        std::vector<Fired> *mFired;
+    };
+
+    /* 不使用随机数, 同一时间点的到期顺序不同也不影响之后的操作 */
+    static constexpr auto onExpire = [](typename Loop::TimerNode &timer) {
+        auto &node = static_cast<Node &>(timer);
+        auto now = VirtualClock::now();
+        node.mFired->push_back({(now - kStart).count(), node.mId});
+        if (node.mId % 5 == 0 && node.mRearms < 3) {
+            ++node.mRearms;
+            node.m_expireTime = now + std::chrono::milliseconds((node.mId * 7 + node.mRearms) % 300);
+            node.mLoop->addTimer(node);
+        }
+    };
+
+    std::mt19937 rng(seed);
+    VirtualClock::reset(kStart);
+    Loop loop;
+    std::vector<Fired> fired;
+    auto nodes = std::make_unique<Node[]>(kChurnTimers);
+    for (int i = 0; i < kChurnTimers; ++i) {
+        nodes[i].mId = i;
+        nodes[i].mLoop = &loop;
+        nodes[i].mFired = &fired;
+        nodes[i].m_callback = +onExpire;
+    }
+    for (int step = 0; step < kChurnSteps; ++step) {
+        auto now = VirtualClock::now();
+        Node &node = nodes[rng() % kChurnTimers];
+        switch (rng() % 10) {
+        case 0: case 1: case 2: case 3:
+            if (!node.m_pending) {
+                /* 偶尔是已经过去的时间点 */
+                node.m_expireTime = now + std::chrono::milliseconds((std::int64_t) (rng() % 2000) - 5);
+                loop.addTimer(node);
+            }
+            break;
+        case 4: case 5:
+            loop.cancelTimer(node);
+            break;
+        case 6:
+            if (node.m_pending) {
+                loop.cancelTimer(node);
+                node.m_expireTime = now + std::chrono::milliseconds(rng() % 500);
+                loop.addTimer(node);
+            }
+            break;
+        default:
+            VirtualClock::advance(std::chrono::milliseconds(rng() % 50));
+            loop.runExpired();
+            break;
+        }
+    }
+    while (loop.run()) {
+    }
+    CHECK(!loop.hasEvent());
+    std::sort(fired.begin(), fired.end());
+    return fired;
+}
+
+int main() {
+    for (std::uint32_t seed: {1u, 2u, 3u}) {
+        auto plan = makePlan(seed);
+        auto expected = simulate<OrderedTimerQueue>(plan);
+        /* 未到期前被取消的定时器之外, 都在自己的到期时间 (过去的为开始时间) 到期 */
+        for (Fired const &fired: expected) {
+            if (fired.id < kTimers && fired.id % 97 != 0) {
+                CHECK(fired.time == std::chrono::nanoseconds(plan[fired.id].delay).count());
+            }
+        }
+        CHECK(expected.size() > kTimers / 2);
+        CHECK(simulate<TimingWheel>(plan) == expected);
+        CHECK(simulate<HeapTimerQueue>(plan) == expected);
+        CHECK(simulate<PairingTimerQueue>(plan) == expected);
+
+        expected = churn<OrderedTimerQueue>(seed);
+        CHECK(expected.size() > kChurnTimers);
+        CHECK(churn<HeapTimerQueue>(seed) == expected);
+        CHECK(churn<PairingTimerQueue>(seed) == expected);
+        CHECK(churn<TimingWheel>(seed) == expected);
+    }
+    return 0;
+}
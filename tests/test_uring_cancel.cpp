@@ -0,0 +1,60 @@
+#include "co_async/debug.hpp"
+#include "co_async/async_loop.hpp"
+#include "check.hpp"
+
+#include <cstring>
+#include <unistd.h>
+
+/**
+ * 取消挂起中的 io_uring 读取: 等待者要等内核确认取消之后才恢复,
+ * 之后写入管道的数据既不能写进已经交还给调用者的缓冲区, 也不能被取消的读取消耗掉
+ */
+
+using namespace co_async;
+using namespace std::chrono_literals;
+
+static char buffer[16];
+
+static Task<> reader(UringAsyncLoop &loop, AsyncFile &file, bool &cancelled) {
+    try {
+        co_await read_file(loop, file, buffer);
+    } catch (std::system_error const &e) {
+        cancelled = e.code() == std::errc::operation_canceled;
+    }
+}
+
+static Task<> canceller(UringAsyncLoop &loop, CancelSource &source) {
+    co_await sleep_for(loop, 5ms);
+    source.cancel();
+}
+
+static Task<> run(UringAsyncLoop &loop, AsyncFile &file, int writeEnd) {
+    CancelSource source;
+    bool cancelled = false;
+    auto task = with_cancel(reader(loop, file, cancelled), source.token());
+    auto stop = canceller(loop, source);
+    co_await when_all(task, stop);
+    CHECK(cancelled);
+
+    std::strcpy(buffer, "USERDATA");
+    CHECK(write(writeEnd, "KERNELDATA", 10) == 10);
+    co_await sleep_for(loop, 20ms);
+    CHECK(std::strcmp(buffer, "USERDATA") == 0);
+
+    char rest[16]{};
+    CHECK(co_await read_file(loop, file, rest) == 10);
+    CHECK(std::memcmp(rest, "KERNELDATA", 10) == 0);
+}
+
+int main() {
+    UringAsyncLoop loop;
+    if (!static_cast<UringLoop &>(loop).supported()) {
+        return 77;
+    }
+    int fds[2];
+    checkError(pipe(fds));
+    AsyncFile file(fds[0]);
+    run_task(loop, run(loop, file, fds[1]));
+    close(fds[1]);
+    return 0;
+}
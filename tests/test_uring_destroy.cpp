@@ -0,0 +1,61 @@
+#include "co_async/debug.hpp"
+#include "co_async/async_loop.hpp"
+#include "check.hpp"
+
+#include <cstring>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+/**
+ * 读取还在内核中时销毁它的协程帧(when_any 中落败的一方): 析构要确认内核已经撤销了请求才返回,
+ * 之后写入管道的数据不能写进已经释放的帧, 也不能被已经销毁的读取消耗掉
+ * 等待中的管道读取可以立即撤销, 析构不应该阻塞, 原请求的完成事件在下一轮循环中回收
+ * 链接了 poll 的读写(内核遵从 O_NONBLOCK 时的模式)也一样
+ */
+
+using namespace co_async;
+using namespace std::chrono_literals;
+
+static Task<std::size_t> readLocal(UringAsyncLoop &loop, AsyncFile &file) {
+    char buffer[16];
+    co_return co_await read_file(loop, file, buffer);
+}
+
+static Task<> run(UringAsyncLoop &loop, AsyncFile &file, int writeEnd) {
+    auto const &stats = static_cast<UringLoop &>(loop).uringStats();
+    for (int i = 0; i < 3; ++i) {
+        std::size_t completions = stats.completions;
+        auto result = co_await when_any(readLocal(loop, file), sleep_for(loop, 5ms));
+        CHECK(result.index() == 1);
+        CHECK(stats.blockingWaits == 0);
+        co_await yield(loop);
+        CHECK(stats.completions == completions + 1);
+        CHECK(write(writeEnd, "KERNELDATA", 10) == 10);
+        int available = 0;
+        CHECK(ioctl(file.fileNo(), FIONREAD, &available) == 0);
+        CHECK(available == 10);
+        char rest[16]{};
+        CHECK(read(file.fileNo(), rest, sizeof(rest)) == 10);
+        CHECK(std::memcmp(rest, "KERNELDATA", 10) == 0);
+    }
+
+    /* 循环中不能残留已经销毁的请求 */
+    auto result = co_await when_any(readLocal(loop, file), sleep_for(loop, 20ms));
+    CHECK(result.index() == 1);
+}
+
+int main() {
+    for (bool pollFirst: {false, true}) {
+        UringAsyncLoop loop;
+        if (!static_cast<UringLoop &>(loop).supported()) {
+            return 77;
+        }
+        static_cast<UringLoop &>(loop).setPollFirst(pollFirst);
+        int fds[2];
+        checkError(pipe(fds));
+        AsyncFile file(fds[0]);
+        run_task(loop, run(loop, file, fds[1]));
+        close(fds[1]);
+    }
+    return 0;
+}
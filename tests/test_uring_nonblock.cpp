@@ -0,0 +1,81 @@
+#include "co_async/debug.hpp"
+#include "co_async/async_loop.hpp"
+#include "check.hpp"
+
+#include <fcntl.h>
+#include <cstring>
+#include <unistd.h>
+
+/**
+ * 非阻塞 fd 上的 io_uring 读写: 无论内核是否忽略 O_NONBLOCK, 还是循环改为先链接 poll,
+ * 等待就绪都在 io_uring 中完成, 管道不会注册到 epoll 里, 每次读写只提交一次
+ */
+
+using namespace co_async;
+using namespace std::chrono_literals;
+
+static Task<> writeLater(UringAsyncLoop &loop, AsyncFile &file, char const *data) {
+    std::span<char const> buffer(data, std::strlen(data));
+    co_await sleep_for(loop, 2ms);
+    CHECK(co_await write_file(loop, file, buffer) == buffer.size());
+}
+
+static Task<> readCancelled(UringAsyncLoop &loop, AsyncFile &file, bool &cancelled) {
+    char buffer[16];
+    auto n = co_await try_read_file(loop, file, buffer);
+    cancelled = n.error() == std::errc::operation_canceled;
+}
+
+static Task<> cancelLater(UringAsyncLoop &loop, CancelSource &source) {
+    co_await sleep_for(loop, 2ms);
+    source.cancel();
+}
+
+static Task<> run(UringAsyncLoop &loop, AsyncFile &readEnd, AsyncFile &writeEnd) {
+    auto &uring = static_cast<UringLoop &>(loop);
+    std::size_t ctlCalls = loop.stats().ctlCalls;
+    for (int i = 0; i < 3; ++i) {
+        auto writer = writeLater(loop, writeEnd, "hello");
+        spawn_task(writer);
+        std::size_t submitted = uring.uringStats().submitted;
+        char buffer[16]{};
+        CHECK(co_await read_file(loop, readEnd, buffer) == 5);
+        CHECK(std::memcmp(buffer, "hello", 5) == 0);
+        /* 读取在管道为空时提交, 数据到达后才完成, 读和写都没有重新提交 */
+        CHECK(uring.uringStats().submitted - submitted == (uring.pollFirst() ? 4 : 2));
+        co_await yield(loop);
+    }
+
+    CancelSource source;
+    bool cancelled = false;
+    auto reader = with_cancel(readCancelled(loop, readEnd, cancelled), source.token());
+    auto stop = cancelLater(loop, source);
+    spawn_task(stop);
+    co_await reader;
+    CHECK(cancelled);
+    co_await yield(loop);
+
+    /* 取消之后数据仍然完整地留给下一次读取 */
+    CHECK(write(writeEnd.fileNo(), "after", 5) == 5);
+    char buffer[16]{};
+    CHECK(co_await read_file(loop, readEnd, buffer) == 5);
+    CHECK(std::memcmp(buffer, "after", 5) == 0);
+
+    CHECK(loop.stats().ctlCalls == ctlCalls);
+}
+
+int main() {
+    for (bool pollFirst: {false, true}) {
+        UringAsyncLoop loop;
+        if (!static_cast<UringLoop &>(loop).supported()) {
+            return 77;
+        }
+        static_cast<UringLoop &>(loop).setPollFirst(pollFirst);
+        int fds[2];
+        checkError(pipe2(fds, O_NONBLOCK | O_CLOEXEC));
+        AsyncFile readEnd(fds[0]);
+        AsyncFile writeEnd(fds[1]);
+        run_task(loop, run(loop, readEnd, writeEnd));
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include "co_async/debug.hpp"
+#include "co_async/async_loop.hpp"
+#include "check.hpp"
+
+#include <chrono>
+#include <unistd.h>
+
+/**
+ * VirtualClock 只在循环无事可做时才跳到下一个定时器:
+ * 就绪的协程和已经发生的 fd 事件都要在时间推进之前处理, 长时间的模拟不需要真的等待
+ */
+
+using namespace co_async;
+using namespace std::chrono_literals;
+
+static std::chrono::milliseconds elapsed() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(VirtualClock::now().time_since_epoch());
+}
+
+static Task<> sleepThenYield(VirtualAsyncLoop &loop) {
+    co_await sleep_for(loop, 1s);
+    CHECK(elapsed() == 1000ms);
+    co_await yield(loop);
+    CHECK(elapsed() == 1000ms);
+    co_await sleep_for(loop, 1s);
+    CHECK(elapsed() == 2000ms);
+}
+
+static Task<> longSleep(VirtualAsyncLoop &loop) {
+    co_await sleep_for(loop, 10s);
+    CHECK(elapsed() == 10000ms);
+}
+
+static Task<> readPipe(VirtualAsyncLoop &loop, AsyncFile &file) {
+    char byte;
+    CHECK(co_await read_file(loop, file, {&byte, 1}) == 1);
+    /* 管道中已经有数据, 不应该先跳到定时器的到期时间 */
+    CHECK(elapsed() == 0ms);
+}
+
+/* 一小时一次的重试, 模拟一整年 */
+static Task<> retries(VirtualAsyncLoop &loop, int &count) {
+    for (count = 0; count < 24 * 365; ++count) {
+        co_await sleep_for(loop, 1h);
+    }
+}
+
+static Task<> standalone(VirtualTimerLoop &loop) {
+    co_await sleep_for(loop, 3s);
+    CHECK(elapsed() == 3000ms);
+}
+
+int main() {
+    {
+        VirtualAsyncLoop loop;
+        VirtualClock::reset();
+        auto first = sleepThenYield(loop);
+        auto second = longSleep(loop);
+        spawn_task(first);
+        run_task(loop, second);
+        CHECK(elapsed() == 10000ms);
+    }
+    {
+        VirtualAsyncLoop loop;
+        VirtualClock::reset();
+        int fds[2];
+        checkError(pipe(fds));
+        CHECK(write(fds[1], "x", 1) == 1);
+        AsyncFile file(fds[0]);
+        auto sleeper = longSleep(loop);
+        spawn_task(sleeper);
+        run_task(loop, readPipe(loop, file));
+        while (loop.run()) {
+        }
+        close(fds[1]);
+    }
+    {
+        VirtualAsyncLoop loop;
+        VirtualClock::reset();
+        int count = 0;
+        auto start = std::chrono::steady_clock::now();
+        run_task(loop, retries(loop, count));
+        CHECK(count == 24 * 365);
+        CHECK(elapsed() == std::chrono::hours(24 * 365));
+        CHECK(std::chrono::steady_clock::now() - start < 5s);
+    }
+    {
+        VirtualTimerLoop loop;
+        VirtualClock::reset();
+        run_task(loop, standalone(loop));
+    }
+    return 0;
+}
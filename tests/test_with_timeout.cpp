@@ -0,0 +1,86 @@
+#include "co_async/debug.hpp"
+#include "co_async/async_loop.hpp"
+#include "co_async/with_timeout.hpp"
+#include "check.hpp"
+
+#include <fcntl.h>
+#include <cstring>
+#include <unistd.h>
+
+/**
+ * with_timeout 的两种结果: 操作先完成时返回它的值, 定时器先到期时通过 CancelToken 取消操作,
+ * 等操作恢复之后才返回空; 不支持取消的操作 (yield) 只会在完成之后返回,
+ * 已经交给循环的协程帧不会被提前销毁; 调用者自己被取消时抛出 operation_canceled
+ */
+
+using namespace co_async;
+using namespace std::chrono_literals;
+
+static Task<int> answer(AsyncLoop &loop) {
+    co_await sleep_for(loop, 1ms);
+    co_return 42;
+}
+
+static Task<int> readAll(AsyncLoop &loop, AsyncFile &file) {
+    char buffer[16];
+    co_return (int) co_await read_file(loop, file, buffer);
+}
+
+static Task<> slowTimeout(AsyncLoop &loop, bool &cancelled) {
+    try {
+        (void) co_await with_timeout(loop, sleep_for(loop, 10s), 10s);
+    } catch (std::system_error const &e) {
+        cancelled = e.code() == std::errc::operation_canceled;
+    }
+}
+
+static Task<> run(AsyncLoop &loop, AsyncFile &readEnd, AsyncFile &writeEnd) {
+    auto start = std::chrono::steady_clock::now();
+
+    /* 操作先完成 */
+    CHECK(co_await with_timeout(loop, sleep_for(loop, 1ms), 1s));
+    auto value = co_await with_timeout(loop, answer(loop), 1s);
+    CHECK(value && *value == 42);
+    auto task = answer(loop);
+    value = co_await with_timeout(loop, task, 1s);
+    CHECK(value && *value == 42);
+
+    /* 定时器先到期 */
+    CHECK(!co_await with_timeout(loop, sleep_for(loop, 10s), 5ms));
+    CHECK(!co_await with_timeout(loop, readAll(loop, readEnd), 5ms));
+    char buffer[16];
+    std::span<char> span(buffer);
+    CHECK(!co_await with_timeout(loop, try_read_file(loop, readEnd, span), 5ms));
+    CHECK(std::chrono::steady_clock::now() - start < 1s);
+
+    /* 被取消的读取没有拿走数据 */
+    CHECK(write(writeEnd.fileNo(), "data", 4) == 4);
+    value = co_await with_timeout(loop, readAll(loop, readEnd), 1s);
+    CHECK(value && *value == 4);
+
+    /* yield 不能取消, 即使定时器先到期也要等它恢复 */
+    for (int i = 0; i < 10; ++i) {
+        CHECK(co_await with_timeout(loop, yield(loop), 0s));
+    }
+
+    /* 调用者被取消 */
+    CancelSource source;
+    bool cancelled = false;
+    auto outer = with_cancel(slowTimeout(loop, cancelled), source.token());
+    spawn_task(outer);
+    co_await sleep_for(loop, 1ms);
+    source.cancel();
+    co_await sleep_for(loop, 1ms);
+    CHECK(cancelled);
+    CHECK(std::chrono::steady_clock::now() - start < 1s);
+}
+
+int main() {
+    AsyncLoop loop;
+    int fds[2];
+    checkError(pipe2(fds, O_NONBLOCK | O_CLOEXEC));
+    AsyncFile readEnd(fds[0]);
+    AsyncFile writeEnd(fds[1]);
+    run_task(loop, run(loop, readEnd, writeEnd));
+    return 0;
+}